@@ -79,6 +79,19 @@ class TimeWriteLong:
         pt.frame_to_hyper(self.df, "dummy.hyper", table="dummy")
 
 
+class TimeWriteWide:
+    params = ["inserter", "copy"]
+    param_names = ["engine"]
+
+    def setup(self, engine):
+        self.df = pd.DataFrame(
+            np.ones((1_000_000, 50)), columns=[f"col{i}" for i in range(50)]
+        )
+
+    def time_write_frame(self, engine):
+        pt.frame_to_hyper(self.df, "dummy.hyper", table="dummy", engine=engine)
+
+
 class TimeReadLong:
     def setup(self):
         df = pd.DataFrame(np.ones((10_000_000, 1)), columns=["a"])
@@ -1,14 +1,33 @@
 __version__ = "5.2.2"
 
 
-from pantab._reader import frame_from_hyper, frame_from_hyper_query, frames_from_hyper
-from pantab._writer import frame_to_hyper, frames_to_hyper
+from pantab._reader import (
+    frame_from_hyper,
+    frame_from_hyper_query,
+    frames_from_hyper,
+    statistics_from_hyper,
+    statistics_from_sidecar,
+)
+from pantab._session import Session
+from pantab._writer import (
+    TableWriter,
+    file_to_hyper,
+    frame_to_hyper,
+    frames_to_hyper,
+    partitioned_frame_to_hyper,
+)
 
 __all__ = [
     "__version__",
+    "Session",
+    "TableWriter",
     "frame_from_hyper",
     "frame_from_hyper_query",
     "frames_from_hyper",
+    "file_to_hyper",
     "frame_to_hyper",
     "frames_to_hyper",
+    "partitioned_frame_to_hyper",
+    "statistics_from_hyper",
+    "statistics_from_sidecar",
 ]
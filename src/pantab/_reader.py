@@ -1,10 +1,131 @@
+import datetime
+import decimal
+import json
+import math
+import numbers
+import os
 import pathlib
-from typing import Literal, Optional, Union
+from typing import Any, Iterable, Literal, Optional, Union
 
 import pyarrow as pa
 
 import pantab._types as pt_types
 import pantab.libpantab as libpantab
+from pantab._session import Session, _get_native_session
+from pantab._writer import _convert_to_table_name, _validate_queue_depth
+
+# tables holding pantab's own bookkeeping rather than data
+_STATISTICS_TABLE = ("public", "__pantab_statistics")
+_RANGE_STATISTICS_TABLE = ("public", "__pantab_statistics_ranges")
+_METADATA_TABLES = {
+    ("public", "__pantab_checkpoints"),
+    _STATISTICS_TABLE,
+    _RANGE_STATISTICS_TABLE,
+}
+
+# the columns of both statistics tables, in the order they are stored
+_STATISTICS_SCHEMA = pa.schema(
+    [
+        ("schema_name", pa.large_string()),
+        ("table_name", pa.large_string()),
+        ("column_name", pa.large_string()),
+        ("column_position", pa.int32()),
+        ("row_count", pa.int64()),
+        ("null_count", pa.int64()),
+        ("distinct_count", pa.int64()),
+        ("min_value", pa.large_string()),
+        ("max_value", pa.large_string()),
+    ]
+)
+_RANGE_STATISTICS_SCHEMA = pa.schema(
+    [
+        ("schema_name", pa.large_string()),
+        ("table_name", pa.large_string()),
+        ("column_name", pa.large_string()),
+        ("column_position", pa.int32()),
+        ("first_row", pa.int64()),
+        ("row_count", pa.int64()),
+        ("null_count", pa.int64()),
+        ("min_value", pa.large_string()),
+        ("max_value", pa.large_string()),
+    ]
+)
+
+
+# comparison operators accepted in ``filter`` predicates and their SQL spelling
+_FILTER_OPERATORS = {
+    "==": "=",
+    "=": "=",
+    "!=": "<>",
+    "<": "<",
+    "<=": "<=",
+    ">": ">",
+    ">=": ">=",
+}
+
+
+def _to_sql_literal(value: Any) -> str:
+    """Renders a Python scalar as an escaped Hyper SQL literal."""
+    if isinstance(value, bool):
+        return "TRUE" if value else "FALSE"
+    elif isinstance(value, numbers.Integral):
+        return str(int(value))
+    elif isinstance(value, decimal.Decimal):
+        if not value.is_finite():
+            raise ValueError(f"Cannot filter on non-finite value {value!r}")
+        return str(value)
+    elif isinstance(value, numbers.Real):
+        if not math.isfinite(value):
+            raise ValueError(f"Cannot filter on non-finite value {value!r}")
+        return repr(float(value))
+    elif isinstance(value, str):
+        return libpantab.escape_sql_string_literal(value)
+    elif isinstance(value, datetime.datetime):
+        sql_type = "TIMESTAMP" if value.tzinfo is None else "TIMESTAMPTZ"
+        literal = libpantab.escape_sql_string_literal(value.isoformat(sep=" "))
+        return f"{sql_type} {literal}"
+    elif isinstance(value, datetime.date):
+        return f"DATE {libpantab.escape_sql_string_literal(value.isoformat())}"
+    elif isinstance(value, datetime.time):
+        return f"TIME {libpantab.escape_sql_string_literal(value.isoformat())}"
+
+    raise TypeError(f"Unsupported filter value type: {type(value).__name__}")
+
+
+def _compile_filter(filter: Iterable[tuple[str, str, Any]]) -> str:
+    """
+    Compiles ``(column, operator, value)`` predicates into the body of a WHERE
+    clause, combining them with AND.
+    """
+    clauses = []
+    for predicate in filter:
+        if not isinstance(predicate, tuple) or len(predicate) != 3:
+            raise ValueError(
+                "Each filter predicate must be a (column, operator, value) tuple"
+            )
+
+        column, op, value = predicate
+        identifier = libpantab.escape_sql_identifier(column)
+        if op in {"in", "not in"}:
+            if isinstance(value, (str, bytes)) or not isinstance(value, Iterable):
+                raise ValueError(f"'{op}' filters require a collection of values")
+            literals = [_to_sql_literal(x) for x in value]
+            if not literals:
+                raise ValueError(f"'{op}' filters require at least one value")
+            keyword = "IN" if op == "in" else "NOT IN"
+            clauses.append(f"{identifier} {keyword} ({', '.join(literals)})")
+        elif op not in _FILTER_OPERATORS:
+            raise ValueError(f"Unsupported filter operator: {op!r}")
+        elif value is None:
+            if op not in {"==", "=", "!="}:
+                raise ValueError(f"Operator '{op}' cannot be compared with None")
+            null_test = "IS NOT NULL" if op == "!=" else "IS NULL"
+            clauses.append(f"{identifier} {null_test}")
+        else:
+            literal = _to_sql_literal(value)
+            clauses.append(f"{identifier} {_FILTER_OPERATORS[op]} {literal}")
+
+    return " AND ".join(clauses)
 
 
 class PantabStream:
@@ -22,6 +143,21 @@ class PantabStream:
         return self._capsule
 
 
+def _convert_table(tbl: pa.Table, return_type: Literal["pandas", "polars", "pyarrow"]):
+    if return_type == "pyarrow":
+        return tbl
+    elif return_type == "polars":
+        import polars as pl
+
+        return pl.from_arrow(tbl)
+    elif return_type == "pandas":
+        import pandas as pd
+
+        return tbl.to_pandas(types_mapper=pd.ArrowDtype)
+
+    raise NotImplementedError("Please choose an appropriate 'return_type' value")
+
+
 def frame_from_hyper_query(
     source: Union[str, pathlib.Path],
     query: str,
@@ -29,6 +165,8 @@ def frame_from_hyper_query(
     return_type: Literal["pandas", "polars", "pyarrow", "stream"] = "pandas",
     process_params: Optional[dict[str, str]] = None,
     chunk_size=0,
+    queue_depth: int = 0,
+    session: Optional[Session] = None,
 ):
     """
     Executes a SQL query and returns the result as a pandas dataframe
@@ -38,38 +176,30 @@ def frame_from_hyper_query(
     :param return_type: The type of result to be returned
     :param process_params: Parameters to pass to the Hyper Process constructor.
     :param chunk_size: When returning a stream, the number of rows in each chunk to be read
+    :param queue_depth: Number of result chunks to fetch and decode ahead of the chunk being consumed. Decoding happens on a background thread, so reading from Hyper overlaps with downstream processing at the cost of holding more chunks in memory. A value of 0 decodes each chunk when it is requested.
+    :param session: A running :class:`pantab.Session` to read through, rather than starting a new Hyper process. Cannot be combined with ``process_params``.
     """
     if chunk_size and return_type != "stream":
         raise NotImplementedError(
             "Chunking support is only implemented with return_type='stream'"
         )
 
+    _validate_queue_depth(queue_depth)
+
+    native_session = _get_native_session(session, process_params)
     if process_params is None:
         process_params = {}
 
     # Call native library to read tuples from result set
     capsule = libpantab.read_from_hyper_query(
-        str(source), query, process_params, chunk_size
+        str(source), query, process_params, chunk_size, queue_depth, native_session
     )
 
     if return_type == "stream":
         return PantabStream(capsule)
 
     stream = pa.RecordBatchReader._import_from_c_capsule(capsule)
-    tbl = stream.read_all()
-
-    if return_type == "pyarrow":
-        return tbl
-    elif return_type == "polars":
-        import polars as pl
-
-        return pl.from_arrow(tbl)
-    elif return_type == "pandas":
-        import pandas as pd
-
-        return tbl.to_pandas(types_mapper=pd.ArrowDtype)
-
-    raise NotImplementedError("Please choose an appropriate 'return_type' value")
+    return _convert_table(stream.read_all(), return_type)
 
 
 def frame_from_hyper(
@@ -79,15 +209,28 @@ def frame_from_hyper(
     return_type: Literal["pandas", "polars", "pyarrow", "stream"] = "pandas",
     process_params: Optional[dict[str, str]] = None,
     chunk_size=0,
+    queue_depth: int = 0,
+    session: Optional[Session] = None,
+    columns: Optional[list[str]] = None,
+    filter: Optional[list[tuple[str, str, Any]]] = None,
+    limit: Optional[int] = None,
 ):
     """
     Extracts a DataFrame from a .hyper extract.
 
+    Projections, predicates and limits are compiled into the query, so Hyper
+    only scans and returns the requested rows and columns.
+
     :param source: Name / location of the Hyper file to be read  or Hyper-API connection.
     :param table: Table to read.
+    :param columns: Names of the columns to read, in the order they should be returned. Reads every column by default.
+    :param filter: ``(column, operator, value)`` predicates that rows must all satisfy. Operators are ``==``, ``!=``, ``<``, ``<=``, ``>``, ``>=``, ``in`` and ``not in``; comparing with ``None`` via ``==`` / ``!=`` tests for nulls. Values may be booleans, numbers, strings, dates, times or datetimes and are escaped before being sent to Hyper.
+    :param limit: Maximum number of rows to read.
     :param return_type: The type of DataFrame to be returned
     :param process_params: Parameters to pass to the Hyper Process constructor.
     :param chunk_size: When returning a stream, the number of rows in each chunk to be read
+    :param queue_depth: Number of result chunks to fetch and decode ahead of the chunk being consumed. Decoding happens on a background thread, so reading from Hyper overlaps with downstream processing at the cost of holding more chunks in memory. A value of 0 decodes each chunk when it is requested.
+    :param session: A running :class:`pantab.Session` to read through, rather than starting a new Hyper process. Cannot be combined with ``process_params``.
     """
     if isinstance(table, (pt_types.TableauName, pt_types.TableauTableName)):
         tbl = str(table)
@@ -98,13 +241,29 @@ def frame_from_hyper(
     else:
         tbl = libpantab.escape_sql_identifier(table)
 
-    query = f"SELECT * FROM {tbl}"
+    if columns is None:
+        projection = "*"
+    elif isinstance(columns, str) or not columns:
+        raise ValueError("'columns' must be a non-empty list of column names")
+    else:
+        projection = ", ".join(libpantab.escape_sql_identifier(x) for x in columns)
+
+    query = f"SELECT {projection} FROM {tbl}"
+    if filter:
+        query += f" WHERE {_compile_filter(filter)}"
+    if limit is not None:
+        if isinstance(limit, bool) or not isinstance(limit, int) or limit < 0:
+            raise ValueError("'limit' must be a non-negative integer")
+        query += f" LIMIT {limit}"
+
     return frame_from_hyper_query(
         source,
         query,
         return_type=return_type,
         process_params=process_params,
         chunk_size=chunk_size,
+        queue_depth=queue_depth,
+        session=session,
     )
 
 
@@ -113,6 +272,8 @@ def frames_from_hyper(
     return_type: Literal["pandas", "polars", "pyarrow", "stream"] = "pandas",
     process_params: Optional[dict[str, str]] = None,
     chunk_size=0,
+    queue_depth: int = 0,
+    session: Optional[Session] = None,
 ):
     """
     Extracts tables from a .hyper extract.
@@ -121,17 +282,148 @@ def frames_from_hyper(
     :param return_type: The type of DataFrame to be returned
     :param process_params: Parameters to pass to the Hyper Process constructor.
     :param chunk_size: When returning a stream, the number of rows in each chunk to be read
+    :param queue_depth: Number of result chunks to fetch and decode ahead of the chunk being consumed. Decoding happens on a background thread, so reading from Hyper overlaps with downstream processing at the cost of holding more chunks in memory. A value of 0 decodes each chunk when it is requested.
+    :param session: A running :class:`pantab.Session` to read through, rather than starting a new Hyper process. Cannot be combined with ``process_params``.
     """
     result = {}
 
-    table_names = libpantab.get_table_names(str(source))
+    table_names = libpantab.get_table_names(
+        str(source), _get_native_session(session, process_params)
+    )
     for table in table_names:
+        if table in _METADATA_TABLES:
+            continue
         result[table] = frame_from_hyper(
             source=source,
             table=table,
             return_type=return_type,
             process_params=process_params,
             chunk_size=chunk_size,
+            queue_depth=queue_depth,
+            session=session,
         )
 
     return result
+
+
+def _table_condition(table: pt_types.TableNameType) -> str:
+    table = _convert_to_table_name(table)
+    schema_name, table_name = table if isinstance(table, tuple) else ("public", table)
+
+    schema_literal = libpantab.escape_sql_string_literal(schema_name)
+    table_literal = libpantab.escape_sql_string_literal(table_name)
+    return f"schema_name = {schema_literal} AND table_name = {table_literal}"
+
+
+def statistics_from_hyper(
+    source: Union[str, pathlib.Path],
+    *,
+    table: Optional[pt_types.TableNameType] = None,
+    ranges: bool = False,
+    return_type: Literal["pandas", "polars", "pyarrow"] = "pandas",
+    process_params: Optional[dict[str, str]] = None,
+    session: Optional[Session] = None,
+):
+    """
+    Reads the column statistics recorded by writes with ``statistics`` enabled.
+
+    The result has one row per column of every table with statistics, holding
+    its ``row_count``, ``null_count`` and ``min_value`` / ``max_value``
+    rendered as text. ``distinct_count`` is only known after a write with
+    ``statistics="rescan"``, as distinct counts of separate writes cannot be
+    added up. Types without an ordering, such as geography or binary columns,
+    have no minimum or maximum.
+
+    With ``ranges``, the result instead has one row per column of every write,
+    whose rows start at ``first_row`` within the table. A write that replaced
+    rows of a table, or rescanned it, leaves a single range covering all of
+    it.
+
+    :param source: Name / location of the Hyper file to be read.
+    :param table: Only return the statistics of this table. Unqualified names refer to the "public" schema.
+    :param ranges: Whether to return the statistics of each written row range rather than of whole tables.
+    :param return_type: The type of DataFrame to be returned
+    :param process_params: Parameters to pass to the Hyper Process constructor.
+    :param session: A running :class:`pantab.Session` to read through, rather than starting a new Hyper process. Cannot be combined with ``process_params``.
+    """
+    statistics_table = _RANGE_STATISTICS_TABLE if ranges else _STATISTICS_TABLE
+    table_names = libpantab.get_table_names(
+        str(source), _get_native_session(session, process_params)
+    )
+    if statistics_table not in table_names:
+        raise ValueError(f"No statistics have been recorded in {source}")
+
+    query = "SELECT * FROM " + ".".join(
+        libpantab.escape_sql_identifier(x) for x in statistics_table
+    )
+    if table is not None:
+        query += " WHERE " + _table_condition(table)
+    query += (
+        " ORDER BY schema_name, table_name, first_row, column_position"
+        if ranges
+        else " ORDER BY schema_name, table_name, column_position"
+    )
+
+    return frame_from_hyper_query(
+        source,
+        query,
+        return_type=return_type,
+        process_params=process_params,
+        session=session,
+    )
+
+
+def _write_statistics_sidecar(
+    source: Union[str, pathlib.Path],
+    path: Union[str, pathlib.Path],
+    *,
+    process_params: Optional[dict[str, str]] = None,
+    session: Optional[Session] = None,
+) -> None:
+    """Dumps the recorded statistics of source to a JSON file at path"""
+    contents = {
+        key: statistics_from_hyper(
+            source,
+            ranges=ranges,
+            return_type="pyarrow",
+            process_params=process_params,
+            session=session,
+        ).to_pylist()
+        for key, ranges in (("statistics", False), ("ranges", True))
+    }
+
+    # readers never see a partially written sidecar
+    path = pathlib.Path(path)
+    tmp_path = path.with_name(f"{path.name}.tmp")
+    with open(tmp_path, "w", encoding="utf-8") as f:
+        json.dump(contents, f)
+    os.replace(tmp_path, path)
+
+
+def statistics_from_sidecar(
+    path: Union[str, pathlib.Path],
+    *,
+    table: Optional[pt_types.TableNameType] = None,
+    ranges: bool = False,
+    return_type: Literal["pandas", "polars", "pyarrow"] = "pandas",
+):
+    """
+    Reads the statistics a write stored in a ``statistics_sidecar`` file, in
+    the same shape as :func:`statistics_from_hyper` returns them. Unlike the
+    statistics inside the Hyper file, reading them does not start Hyper.
+
+    :param path: Location of the sidecar file.
+    :param table: Only return the statistics of this table. Unqualified names refer to the "public" schema.
+    :param ranges: Whether to return the statistics of each written row range rather than of whole tables.
+    :param return_type: The type of DataFrame to be returned
+    """
+    with open(path, encoding="utf-8") as f:
+        rows = json.load(f)["ranges" if ranges else "statistics"]
+
+    if table is not None:
+        table = _convert_to_table_name(table)
+        key = table if isinstance(table, tuple) else ("public", table)
+        rows = [row for row in rows if (row["schema_name"], row["table_name"]) == key]
+
+    schema = _RANGE_STATISTICS_SCHEMA if ranges else _STATISTICS_SCHEMA
+    return _convert_table(pa.Table.from_pylist(rows, schema=schema), return_type)
@@ -0,0 +1,57 @@
+from typing import Optional
+
+import pantab.libpantab as libpantab
+
+
+class Session:
+    """
+    A Hyper process that is kept running across pantab calls.
+
+    Every read and write function starts and stops its own Hyper process unless
+    it is given a session, which saves the startup cost when making many calls.
+    Connections used for reading are also kept open for reuse by later reads of
+    the same database. Sessions can be shared between threads.
+
+    :param process_params: Parameters to pass to the Hyper Process constructor.
+    """
+
+    def __init__(self, process_params: Optional[dict[str, str]] = None):
+        if process_params is None:
+            process_params = {}
+
+        self._session = libpantab.Session(process_params)
+        self._closed = False
+
+    def close(self) -> None:
+        """
+        Shuts down the Hyper process once any streams read through this session
+        have been released.
+        """
+        self._session.close()
+        self._closed = True
+
+    @property
+    def closed(self) -> bool:
+        return self._closed
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
+def _get_native_session(
+    session: Optional[Session], process_params: Optional[dict[str, str]]
+):
+    """Unwraps session, which cannot be combined with process_params"""
+    if session is None:
+        return None
+
+    if process_params is not None:
+        raise ValueError(
+            "'process_params' cannot be used with a 'session'; pass them to the "
+            "Session constructor instead"
+        )
+
+    return session._session
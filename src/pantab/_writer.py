@@ -1,11 +1,18 @@
+import contextlib
+import glob
+import itertools
 import pathlib
 import shutil
+import sys
 import tempfile
 import uuid
 from typing import Any, Literal, Optional, Union
 
+import pyarrow as pa
+
 import pantab._types as pt_types
 import pantab.libpantab as libpantab
+from pantab._session import Session, _get_native_session
 
 
 def _validate_table_mode(table_mode: Literal["a", "w"]) -> None:
@@ -13,31 +20,183 @@ def _validate_table_mode(table_mode: Literal["a", "w"]) -> None:
         raise ValueError("'table_mode' must be either 'w' or 'a'")
 
 
+def _validate_merge_table_mode(
+    table_mode: Literal["a", "w", "m"], key_columns: Optional[list[str]]
+) -> None:
+    if table_mode not in {"a", "w", "m"}:
+        raise ValueError("'table_mode' must be one of 'w', 'a' or 'm'")
+    if table_mode == "m" and not key_columns:
+        raise ValueError("'key_columns' are required when 'table_mode' is 'm'")
+    if table_mode != "m" and key_columns:
+        raise ValueError("'key_columns' can only be used when 'table_mode' is 'm'")
+
+
+def _validate_queue_depth(queue_depth: int) -> None:
+    if queue_depth < 0:
+        raise ValueError("'queue_depth' must be a non-negative integer")
+
+
+def _validate_max_workers(max_workers: int) -> None:
+    if max_workers < 1:
+        raise ValueError("'max_workers' must be a positive integer")
+
+
+def _validate_shards(shards: int) -> None:
+    if shards < 1:
+        raise ValueError("'shards' must be a positive integer")
+
+
+def _validate_engine(engine: Literal["inserter", "copy"]) -> None:
+    if engine not in {"inserter", "copy"}:
+        raise ValueError("'engine' must be either 'inserter' or 'copy'")
+
+
+def _validate_max_open_partitions(max_open_partitions: int) -> None:
+    if max_open_partitions < 1:
+        raise ValueError("'max_open_partitions' must be a positive integer")
+
+
+def _validate_flush_threshold(name: str, value: Optional[int]) -> None:
+    if value is not None and value < 1:
+        raise ValueError(f"'{name}' must be a positive integer")
+
+
+def _to_statistics_mode(statistics: Union[bool, Literal["rescan"]]) -> str:
+    if statistics is True:
+        return "collect"
+    elif statistics is False:
+        return "none"
+    elif statistics == "rescan":
+        return "rescan"
+    raise ValueError("'statistics' must be True, False or 'rescan'")
+
+
+def _validate_statistics_sidecar(
+    statistics: Union[bool, Literal["rescan"]],
+    statistics_sidecar: Optional[Union[str, pathlib.Path]],
+) -> None:
+    if statistics_sidecar is not None and _to_statistics_mode(statistics) == "none":
+        raise ValueError("'statistics_sidecar' requires 'statistics'")
+
+
+def _write_sidecar(
+    database: Union[str, pathlib.Path],
+    statistics_sidecar: Optional[Union[str, pathlib.Path]],
+    process_params: Optional[dict[str, str]],
+    session: Optional[Session],
+) -> None:
+    if statistics_sidecar is None:
+        return
+
+    # the reader builds on this module, so it can only be imported lazily
+    from pantab._reader import _write_statistics_sidecar
+
+    # writers default process_params to an empty dict, which a session rejects
+    _write_statistics_sidecar(
+        database,
+        statistics_sidecar,
+        process_params=process_params if session is None else None,
+        session=session,
+    )
+
+
+def _validate_checkpoint(
+    checkpoint_key: Optional[str],
+    checkpoint_rows: Optional[int],
+    checkpoint_bytes: Optional[int],
+    table_mode: Literal["a", "w", "m"],
+    engine: Literal["inserter", "copy"],
+    max_workers: int,
+    shards: int,
+) -> None:
+    _validate_flush_threshold("checkpoint_rows", checkpoint_rows)
+    _validate_flush_threshold("checkpoint_bytes", checkpoint_bytes)
+    if checkpoint_key is None:
+        if checkpoint_rows is not None or checkpoint_bytes is not None:
+            raise ValueError(
+                "'checkpoint_rows' and 'checkpoint_bytes' require a 'checkpoint_key'"
+            )
+        return
+
+    if table_mode != "a":
+        raise ValueError("Checkpointed loads require table_mode 'a'")
+    if engine != "inserter" or max_workers > 1 or shards > 1:
+        raise ValueError(
+            "Checkpointed loads cannot be combined with the 'copy' engine, "
+            "'max_workers' or 'shards'"
+        )
+
+
+# Number of rows converted to Arrow at a time from pandas or polars frames, so
+# that conversion interleaves with inserting and only a few slices are alive
+_CONVERSION_CHUNK_ROWS = 65_536
+
+
+def _stream_tables(schema: pa.Schema, tables) -> Any:
+    """Returns the stream capsule of an iterable of tables, consumed lazily"""
+
+    def batches():
+        for table in tables:
+            yield from table.to_batches()
+
+    return pa.RecordBatchReader.from_batches(schema, batches()).__arrow_c_stream__()
+
+
+def _get_pandas_capsule(df) -> Any:
+    """Converts df to Arrow one slice of rows at a time"""
+    # Every later slice is converted to the schema of the first one. Object
+    # columns hold arbitrary Python values, which only the whole column can
+    # settle: Decimals whose scale grows, ints followed by floats, or no value
+    # at all within the first slice. Those columns alone are inferred from the
+    # whole frame; every other dtype maps to the same Arrow type in any slice.
+    first = pa.Table.from_pandas(df.iloc[:_CONVERSION_CHUNK_ROWS])
+    schema = first.schema
+    object_positions = [i for i, dtype in enumerate(df.dtypes) if dtype == object]
+    if object_positions:
+        inferred = pa.Schema.from_pandas(
+            df.iloc[:, object_positions], preserve_index=False
+        )
+        for i, field in zip(object_positions, inferred):
+            schema = schema.set(i, field)
+        first = first.cast(schema)
+
+    rest = (
+        pa.Table.from_pandas(
+            df.iloc[start : start + _CONVERSION_CHUNK_ROWS], schema=schema
+        )
+        for start in range(_CONVERSION_CHUNK_ROWS, len(df), _CONVERSION_CHUNK_ROWS)
+    )
+
+    return _stream_tables(schema, itertools.chain([first], rest))
+
+
+def _get_polars_capsule(df) -> Any:
+    """Converts df to Arrow one slice of rows at a time"""
+    tables = (frame.to_arrow() for frame in df.iter_slices(_CONVERSION_CHUNK_ROWS))
+    first = next(tables, None)
+    if first is None:
+        return df.to_arrow().__arrow_c_stream__()
+
+    return _stream_tables(first.schema, itertools.chain([first], tables))
+
+
 def _get_capsule_from_obj(obj):
     """Returns the Arrow capsule underlying obj"""
+    # pandas converts the whole frame at once when asked for a stream, so it is
+    # sliced here instead. If pandas was never imported, obj cannot be one of
+    # its frames.
+    pd = sys.modules.get("pandas")
+    if pd is not None and isinstance(obj, pd.DataFrame):
+        return _get_pandas_capsule(obj)
+
     # Check first for the Arrow C Data Interface compliance
     if hasattr(obj, "__arrow_c_stream__"):
         return obj.__arrow_c_stream__()
 
-    # pandas < 3.0 did not have the Arrow C Data Interface, so
-    # convert to PyArrow
-    try:
-        import pandas as pd
-        import pyarrow as pa
-
-        if isinstance(obj, pd.DataFrame):
-            return pa.Table.from_pandas(obj).__arrow_c_stream__()
-    except ModuleNotFoundError:
-        pass
-
     # see polars GH issue #12530 - PyCapsule interface not yet developed
-    try:
-        import polars as pl
-
-        if isinstance(obj, pl.DataFrame):
-            return obj.to_arrow().__arrow_c_stream__()
-    except ModuleNotFoundError:
-        pass
+    pl = sys.modules.get("polars")
+    if pl is not None and isinstance(obj, pl.DataFrame):
+        return _get_polars_capsule(obj)
 
     # More introspection could happen in the future...but end with TypeError if we
     # can not find what we are looking for
@@ -46,17 +205,92 @@ def _get_capsule_from_obj(obj):
     )
 
 
+def _convert_to_table_name(table: pt_types.TableNameType):
+    if isinstance(table, pt_types.TableauTableName):
+        if table.schema_name:
+            return (table.schema_name.name.unescaped, table.name.unescaped)
+        else:
+            return table.name.unescaped
+    elif isinstance(table, pt_types.TableauName):
+        return table.unescaped
+
+    return table
+
+
+@contextlib.contextmanager
+def _atomic_database_path(
+    database: Union[str, pathlib.Path],
+    table_mode: Literal["a", "w"],
+    atomic: bool,
+    session=None,
+):
+    """Yields the path to write to and whether to write in a single transaction.
+
+    Appends and merges into an existing database are made atomic with a
+    transaction, which avoids copying the file. A database being replaced is
+    instead written to a temporary file that is moved over it once done.
+    """
+    if not (atomic and pathlib.Path(database).exists()):
+        yield database, False
+        return
+
+    if table_mode != "w":
+        yield database, True
+        return
+
+    path_to_write = pathlib.Path(tempfile.gettempdir()) / f"{uuid.uuid4()}.hyper"
+    yield path_to_write, False
+
+    # connections pooled by the session would otherwise keep reading the
+    # replaced file
+    if session is not None:
+        session.drop_connections(str(database))
+    # In Python 3.9+ we can just pass the path object, but due to bpo 32689
+    # and subsequent typeshed changes it is easier to just pass as str for now
+    shutil.move(str(path_to_write), database)
+
+
+def _spool_to_parquet(obj, directory: pathlib.Path):
+    """Writes obj to a Parquet file in directory, one batch at a time.
+
+    Returns the Arrow schema capsule of obj along with the path written to.
+    """
+    import pyarrow.parquet as pq
+
+    reader = pa.RecordBatchReader._import_from_c_capsule(_get_capsule_from_obj(obj))
+    path = directory / f"{uuid.uuid4()}.parquet"
+    # Hyper stores microsecond precision, which is also what the inserter
+    # truncates nanosecond timestamps to
+    with pq.ParquetWriter(
+        path, reader.schema, coerce_timestamps="us", allow_truncated_timestamps=True
+    ) as writer:
+        for batch in reader:
+            writer.write_batch(batch)
+
+    return (reader.schema.__arrow_c_schema__(), [str(path)])
+
+
 def frame_to_hyper(
     df,
     database: Union[str, pathlib.Path],
     *,
     table: pt_types.TableNameType,
-    table_mode: Literal["a", "w"] = "w",
+    table_mode: Literal["a", "w", "m"] = "w",
+    key_columns: Optional[list[str]] = None,
     not_null_columns: Optional[set[str]] = None,
     json_columns: Optional[set[str]] = None,
     geo_columns: Optional[set[str]] = None,
     process_params: Optional[dict[str, str]] = None,
     atomic: bool = True,
+    session: Optional[Session] = None,
+    queue_depth: int = 1,
+    shards: int = 1,
+    engine: Literal["inserter", "copy"] = "inserter",
+    checkpoint_key: Optional[str] = None,
+    checkpoint_rows: Optional[int] = None,
+    checkpoint_bytes: Optional[int] = None,
+    statistics: Union[bool, Literal["rescan"]] = False,
+    statistics_sidecar: Optional[Union[str, pathlib.Path]] = None,
 ) -> None:
     """
     Convert a DataFrame to a .hyper extract.
@@ -64,22 +298,42 @@ def frame_to_hyper(
     :param df: Data to be written out.
     :param database: Name / location of the Hyper file to write to.
     :param table: Table to write to.
-    :param table_mode: The mode to open the table with. Default is "w" for write, which truncates the file before writing. Another option is "a", which will append data to the file if it already contains information.
+    :param table_mode: The mode to open the table with. Default is "w" for write, which truncates the file before writing. Another option is "a", which will append data to the file if it already contains information. "m" merges data into an existing table: rows whose ``key_columns`` match those of an incoming row are replaced by the incoming rows, and all other incoming rows are appended.
+    :param key_columns: Columns identifying a row when merging with ``table_mode="m"``. Null keys compare equal to each other. Every incoming row is inserted, so duplicate keys within the incoming data are all kept.
     :param not_null_columns: Columns which should be considered "NOT NULL" in the target Hyper database. By default, all columns are considered nullable
     :param json_columns: Columns to be written as a JSON data type
     :param geo_columns: Columns to be written as a GEOGRAPHY data type
     :param process_params: Parameters to pass to the Hyper Process constructor.
-    :param atomic: Whether to treat write as atomic. Disabling gives better performance, but failures during write will likely corrupt the Hyper file.
+    :param atomic: Whether to treat write as atomic. Appends to an existing file run in a single Hyper transaction, while overwrites are written to a temporary file that replaces the original once complete. Disabling gives better performance, but failures during write will likely corrupt the Hyper file.
+    :param session: A running :class:`pantab.Session` to write through, rather than starting a new Hyper process. Cannot be combined with ``process_params``.
+    :param queue_depth: Number of Arrow chunks to read ahead of the chunk being inserted. Reading happens on a background thread; larger values can hide slow upstream readers at the cost of holding more chunks in memory. A value of 0 reads chunks serially.
+    :param shards: Number of threads to split each table's stream across. Each shard is encoded into a staging database in parallel, after which the shards are combined into the target table in their original row order.
+    :param engine: How rows are loaded into Hyper. The default "inserter" encodes rows in pantab and streams them to Hyper. "copy" instead spools each frame to a temporary Parquet file and has Hyper bulk load it; ``queue_depth``, ``max_workers`` and ``shards`` do not apply to this engine. Hyper reports nothing about the rows it loads, so this engine reads the spooled files a second time to collect ``statistics``.
+    :param checkpoint_key: Identifies a resumable load. Rows are committed in batches, each recording how many rows of the input have been committed under this key, and a later call with the same key skips the rows committed so far. The key's progress is removed from the file once the load completes. Requires ``table_mode="a"``, bypasses ``atomic`` and cannot be combined with ``max_workers``, ``shards`` or the "copy" engine.
+    :param checkpoint_rows: With ``checkpoint_key``, commit once at least this many rows are pending. By default rows are only committed at the end of each table.
+    :param checkpoint_bytes: With ``checkpoint_key``, commit once at least this many bytes of Arrow data are pending.
+    :param statistics: Whether to record per-column statistics of each written table inside the file, which can be read back with :func:`statistics_from_hyper`. With ``True``, the row count, null count and minimum / maximum value of every column are collected while rows are inserted and added to the statistics recorded by earlier writes, without reading the table; each write is also recorded as a row range of its own. Appending to a table which has rows but no recorded statistics raises. Rows replaced by ``table_mode="m"`` are subtracted from the counts, but minimum / maximum values then only bound the remaining rows. ``"rescan"`` instead aggregates every column over the whole table after the write, which also yields approximate distinct counts but costs a full scan of each table on every write. Writes without statistics discard those recorded for their tables.
+    :param statistics_sidecar: Path of a JSON file to also write the statistics of the file to once the write completes, which :func:`statistics_from_sidecar` reads without starting Hyper. Requires ``statistics``.
     """
     frames_to_hyper(
         {table: df},
         database,
         table_mode=table_mode,
+        key_columns=key_columns,
         not_null_columns=not_null_columns,
         json_columns=json_columns,
         geo_columns=geo_columns,
         process_params=process_params,
         atomic=atomic,
+        session=session,
+        queue_depth=queue_depth,
+        shards=shards,
+        engine=engine,
+        checkpoint_key=checkpoint_key,
+        checkpoint_rows=checkpoint_rows,
+        checkpoint_bytes=checkpoint_bytes,
+        statistics=statistics,
+        statistics_sidecar=statistics_sidecar,
     )
 
 
@@ -87,26 +341,65 @@ def frames_to_hyper(
     dict_of_frames: dict[pt_types.TableNameType, Any],
     database: Union[str, pathlib.Path],
     *,
-    table_mode: Literal["a", "w"] = "w",
+    table_mode: Literal["a", "w", "m"] = "w",
+    key_columns: Optional[list[str]] = None,
     not_null_columns: Optional[set[str]] = None,
     json_columns: Optional[set[str]] = None,
     geo_columns: Optional[set[str]] = None,
     process_params: Optional[dict[str, str]] = None,
     atomic: bool = True,
+    session: Optional[Session] = None,
+    queue_depth: int = 1,
+    max_workers: int = 1,
+    shards: int = 1,
+    engine: Literal["inserter", "copy"] = "inserter",
+    checkpoint_key: Optional[str] = None,
+    checkpoint_rows: Optional[int] = None,
+    checkpoint_bytes: Optional[int] = None,
+    statistics: Union[bool, Literal["rescan"]] = False,
+    statistics_sidecar: Optional[Union[str, pathlib.Path]] = None,
 ) -> None:
     """
     Writes multiple DataFrames to a .hyper extract.
 
     :param dict_of_frames: A dictionary whose keys are valid table identifiers and values are dataframes
     :param database: Name / location of the Hyper file to write to.
-    :param table_mode: The mode to open the table with. Default is "w" for write, which truncates the file before writing. Another option is "a", which will append data to the file if it already contains information.
+    :param table_mode: The mode to open the table with. Default is "w" for write, which truncates the file before writing. Another option is "a", which will append data to the file if it already contains information. "m" merges data into an existing table: rows whose ``key_columns`` match those of an incoming row are replaced by the incoming rows, and all other incoming rows are appended.
+    :param key_columns: Columns identifying a row when merging with ``table_mode="m"``. Null keys compare equal to each other. Every incoming row is inserted, so duplicate keys within the incoming data are all kept.
     :param not_null_columns: Columns which should be considered "NOT NULL" in the target Hyper database. By default, all columns are considered nullable
     :param json_columns: Columns to be written as a JSON data type
     :param geo_columns: Columns to be written as a GEOGRAPHY data type
     :param process_params: Parameters to pass to the Hyper Process constructor.
-    :param atomic: Whether to treat write as atomic. Disabling gives better performance, but failures during write will likely corrupt the Hyper file.
+    :param atomic: Whether to treat write as atomic. Appends to an existing file run in a single Hyper transaction, while overwrites are written to a temporary file that replaces the original once complete. Disabling gives better performance, but failures during write will likely corrupt the Hyper file. When writing more than one table, the tables always share a single Hyper transaction, even with ``atomic=False``: a failure while writing any of them leaves none of them in the file.
+    :param session: A running :class:`pantab.Session` to write through, rather than starting a new Hyper process. Cannot be combined with ``process_params``.
+    :param queue_depth: Number of Arrow chunks to read ahead of the chunk being inserted. Reading happens on a background thread; larger values can hide slow upstream readers at the cost of holding more chunks in memory. A value of 0 reads chunks serially.
+    :param max_workers: Maximum number of tables to ingest concurrently. With more than one worker, each table is encoded into a staging database on its own thread before being copied into the target database.
+    :param shards: Number of threads to split each table's stream across. Each shard is encoded into a staging database in parallel, after which the shards are combined into the target table in their original row order.
+    :param engine: How rows are loaded into Hyper. The default "inserter" encodes rows in pantab and streams them to Hyper. "copy" instead spools each frame to a temporary Parquet file and has Hyper bulk load it; ``queue_depth``, ``max_workers`` and ``shards`` do not apply to this engine. Hyper reports nothing about the rows it loads, so this engine reads the spooled files a second time to collect ``statistics``.
+    :param checkpoint_key: Identifies a resumable load. Rows are committed in batches, each recording how many rows of the input have been committed under this key, and a later call with the same key skips the rows committed so far. The key's progress is removed from the file once the load completes. Requires ``table_mode="a"``, bypasses ``atomic`` and cannot be combined with ``max_workers``, ``shards`` or the "copy" engine.
+    :param checkpoint_rows: With ``checkpoint_key``, commit once at least this many rows are pending. By default rows are only committed at the end of each table.
+    :param checkpoint_bytes: With ``checkpoint_key``, commit once at least this many bytes of Arrow data are pending.
+    :param statistics: Whether to record per-column statistics of each written table inside the file, which can be read back with :func:`statistics_from_hyper`. With ``True``, the row count, null count and minimum / maximum value of every column are collected while rows are inserted and added to the statistics recorded by earlier writes, without reading the table; each write is also recorded as a row range of its own. Appending to a table which has rows but no recorded statistics raises. Rows replaced by ``table_mode="m"`` are subtracted from the counts, but minimum / maximum values then only bound the remaining rows. ``"rescan"`` instead aggregates every column over the whole table after the write, which also yields approximate distinct counts but costs a full scan of each table on every write. Writes without statistics discard those recorded for their tables.
+    :param statistics_sidecar: Path of a JSON file to also write the statistics of the file to once the write completes, which :func:`statistics_from_sidecar` reads without starting Hyper. Requires ``statistics``.
     """
-    _validate_table_mode(table_mode)
+    _validate_merge_table_mode(table_mode, key_columns)
+    _validate_queue_depth(queue_depth)
+    _validate_max_workers(max_workers)
+    _validate_shards(shards)
+    _validate_engine(engine)
+    if engine == "copy" and table_mode == "m":
+        raise ValueError("table_mode 'm' is not supported by the 'copy' engine")
+    _validate_checkpoint(
+        checkpoint_key,
+        checkpoint_rows,
+        checkpoint_bytes,
+        table_mode,
+        engine,
+        max_workers,
+        shards,
+    )
+    statistics_mode = _to_statistics_mode(statistics)
+    _validate_statistics_sidecar(statistics, statistics_sidecar)
 
     if not_null_columns is None:
         not_null_columns = set()
@@ -114,51 +407,364 @@ def frames_to_hyper(
         json_columns = set()
     if geo_columns is None:
         geo_columns = set()
+    native_session = _get_native_session(session, process_params)
     if process_params is None:
         process_params = {}
 
-    if not (atomic and pathlib.Path(database).exists()):
-        needs_copy = False
-        needs_move = False
-        path_to_write = database
+    if checkpoint_key is not None:
+        # every checkpoint commits straight into the database
+        target = contextlib.nullcontext((database, False))
     else:
-        path_to_write = pathlib.Path(tempfile.gettempdir()) / f"{uuid.uuid4()}.hyper"
-        needs_move = True
-        if table_mode == "a":
-            needs_copy = True
+        target = _atomic_database_path(database, table_mode, atomic, native_session)
+
+    with target as (path_to_write, transactional):
+        if engine == "copy":
+            with tempfile.TemporaryDirectory() as spool_dir:
+                sources = {
+                    _convert_to_table_name(key): _spool_to_parquet(
+                        val, pathlib.Path(spool_dir)
+                    )
+                    for key, val in dict_of_frames.items()
+                }
+
+                libpantab.copy_to_hyper(
+                    sources,
+                    path=str(path_to_write),
+                    format="parquet",
+                    table_mode=table_mode,
+                    not_null_columns=not_null_columns,
+                    json_columns=json_columns,
+                    geo_columns=geo_columns,
+                    process_params=process_params,
+                    transactional=transactional,
+                    statistics=statistics_mode,
+                    session=native_session,
+                )
         else:
-            needs_copy = False
-
-    if needs_copy:
-        shutil.copy(database, path_to_write)
-
-    def convert_to_table_name(table: pt_types.TableNameType):
-        if isinstance(table, pt_types.TableauTableName):
-            if table.schema_name:
-                return (table.schema_name.name.unescaped, table.name.unescaped)
-            else:
-                return table.name.unescaped
-        elif isinstance(table, pt_types.TableauName):
-            return table.unescaped
-
-        return table
-
-    data = {
-        convert_to_table_name(key): _get_capsule_from_obj(val)
-        for key, val in dict_of_frames.items()
-    }
-
-    libpantab.write_to_hyper(
-        data,
-        path=str(path_to_write),
+            data = {
+                _convert_to_table_name(key): _get_capsule_from_obj(val)
+                for key, val in dict_of_frames.items()
+            }
+
+            libpantab.write_to_hyper(
+                data,
+                path=str(path_to_write),
+                table_mode=table_mode,
+                not_null_columns=not_null_columns,
+                json_columns=json_columns,
+                geo_columns=geo_columns,
+                process_params=process_params,
+                queue_depth=queue_depth,
+                max_workers=max_workers,
+                shards=shards,
+                key_columns=key_columns or [],
+                transactional=transactional,
+                checkpoint_key=checkpoint_key or "",
+                checkpoint_rows=checkpoint_rows or 0,
+                checkpoint_bytes=checkpoint_bytes or 0,
+                statistics=statistics_mode,
+                session=native_session,
+            )
+
+    _write_sidecar(database, statistics_sidecar, process_params, session)
+
+
+def partitioned_frame_to_hyper(
+    df,
+    database: Union[str, pathlib.Path],
+    *,
+    table: pt_types.TableNameType,
+    partition_by: str,
+    table_mode: Literal["a", "w"] = "w",
+    not_null_columns: Optional[set[str]] = None,
+    json_columns: Optional[set[str]] = None,
+    geo_columns: Optional[set[str]] = None,
+    process_params: Optional[dict[str, str]] = None,
+    session: Optional[Session] = None,
+    queue_depth: int = 1,
+    max_open_partitions: int = 64,
+) -> None:
+    """
+    Splits a DataFrame into one table per distinct value of a column in a single pass.
+
+    Every occurrence of ``{partition}`` in ``database`` and ``table`` is replaced
+    by the partition value, so ``"out/{partition}.hyper"`` writes one file per
+    value while a fixed ``database`` with ``table="sales_{partition}"`` writes one
+    table per value. Within ``database``, the value is percent-encoded wherever it
+    could otherwise leave the directory or form an invalid Windows file name, so
+    path separators, ``:*?"<>|%``, control characters, trailing dots and spaces and
+    the first character of Windows device names such as ``CON`` are written as
+    ``%XX`` escapes. Empty values, and values that differ only in case and would
+    therefore share a file on case-insensitive file systems, raise a ``ValueError``.
+    When every partition goes to the same ``database``, the partitions are staged
+    separately and copied into it in a single transaction, so that either all of
+    them or none are written. Partitions written to files of their own are
+    committed independently of one another.
+
+    :param df: Data to be written out.
+    :param database: Name / location of the Hyper file to write to, optionally containing ``{partition}``.
+    :param table: Table to write to, optionally containing ``{partition}``.
+    :param partition_by: Column whose values select the partition of each row. It must hold integers or strings (optionally dictionary-encoded), without nulls, and is written out along with the other columns.
+    :param table_mode: The mode to open each partition's table with. Default is "w" for write, which truncates the file before writing. Another option is "a", which will append data to the file if it already contains information.
+    :param not_null_columns: Columns which should be considered "NOT NULL" in the target Hyper database. By default, all columns are considered nullable
+    :param json_columns: Columns to be written as a JSON data type
+    :param geo_columns: Columns to be written as a GEOGRAPHY data type
+    :param process_params: Parameters to pass to the Hyper Process constructor.
+    :param session: A running :class:`pantab.Session` to write through, rather than starting a new Hyper process. Cannot be combined with ``process_params``.
+    :param queue_depth: Number of Arrow chunks to read ahead of the chunk being inserted. Reading happens on a background thread; larger values can hide slow upstream readers at the cost of holding more chunks in memory. A value of 0 reads chunks serially.
+    :param max_open_partitions: Maximum number of partitions with an open connection and inserter. Once reached, the least recently written partition commits its rows and is reopened if more of its rows arrive later.
+    """
+    _validate_table_mode(table_mode)
+    _validate_queue_depth(queue_depth)
+    _validate_max_open_partitions(max_open_partitions)
+
+    table = _convert_to_table_name(table)
+    table_parts = table if isinstance(table, tuple) else (table,)
+    if not any("{partition}" in part for part in (str(database), *table_parts)):
+        raise ValueError("Either 'database' or 'table' must contain '{partition}'")
+
+    if not_null_columns is None:
+        not_null_columns = set()
+    if json_columns is None:
+        json_columns = set()
+    if geo_columns is None:
+        geo_columns = set()
+    native_session = _get_native_session(session, process_params)
+    if process_params is None:
+        process_params = {}
+
+    libpantab.write_partitioned_to_hyper(
+        _get_capsule_from_obj(df),
+        path=str(database),
+        table=table,
+        partition_column=partition_by,
         table_mode=table_mode,
         not_null_columns=not_null_columns,
         json_columns=json_columns,
         geo_columns=geo_columns,
         process_params=process_params,
+        queue_depth=queue_depth,
+        max_open_partitions=max_open_partitions,
+        session=native_session,
     )
 
-    if needs_move:
-        # In Python 3.9+ we can just pass the path object, but due to bpo 32689
-        # and subsequent typeshed changes it is easier to just pass as str for now
-        shutil.move(str(path_to_write), database)
+
+class TableWriter:
+    """
+    Writes batches to a single table of a .hyper extract as they arrive.
+
+    The Hyper process, connection and inserter stay open between calls to
+    :meth:`write`, so appending many small batches costs about as much as one
+    large write. Rows are committed once a flush threshold is reached, on
+    :meth:`flush` and when the writer is closed; leaving a ``with`` block with an
+    exception discards the rows written since the last commit. Unlike
+    :func:`frame_to_hyper`, writes go directly to ``database`` and are not
+    atomic.
+
+    :param database: Name / location of the Hyper file to write to.
+    :param table: Table to write to. It is created from the schema of the first batch unless appending to an existing table.
+    :param table_mode: The mode to open the table with. Default is "w" for write, which truncates the file when the writer is opened. Another option is "a", which will append data to the file if it already contains information.
+    :param not_null_columns: Columns which should be considered "NOT NULL" in the target Hyper database. By default, all columns are considered nullable
+    :param json_columns: Columns to be written as a JSON data type
+    :param geo_columns: Columns to be written as a GEOGRAPHY data type
+    :param process_params: Parameters to pass to the Hyper Process constructor.
+    :param flush_rows: Commit once at least this many rows are pending. By default there is no row threshold.
+    :param flush_bytes: Commit once at least this many bytes of Arrow data are pending. By default there is no size threshold.
+    :param session: A running :class:`pantab.Session` to write through, rather than starting a new Hyper process. Cannot be combined with ``process_params``.
+    """
+
+    def __init__(
+        self,
+        database: Union[str, pathlib.Path],
+        *,
+        table: pt_types.TableNameType,
+        table_mode: Literal["a", "w"] = "w",
+        not_null_columns: Optional[set[str]] = None,
+        json_columns: Optional[set[str]] = None,
+        geo_columns: Optional[set[str]] = None,
+        process_params: Optional[dict[str, str]] = None,
+        flush_rows: Optional[int] = None,
+        flush_bytes: Optional[int] = None,
+        session: Optional[Session] = None,
+    ):
+        _validate_table_mode(table_mode)
+        _validate_flush_threshold("flush_rows", flush_rows)
+        _validate_flush_threshold("flush_bytes", flush_bytes)
+
+        if not_null_columns is None:
+            not_null_columns = set()
+        if json_columns is None:
+            json_columns = set()
+        if geo_columns is None:
+            geo_columns = set()
+        native_session = _get_native_session(session, process_params)
+        if process_params is None:
+            process_params = {}
+
+        self._writer = libpantab.TableWriter(
+            str(database),
+            _convert_to_table_name(table),
+            table_mode=table_mode,
+            not_null_columns=not_null_columns,
+            json_columns=json_columns,
+            geo_columns=geo_columns,
+            process_params=process_params,
+            flush_rows=flush_rows or 0,
+            flush_bytes=flush_bytes or 0,
+            session=native_session,
+        )
+
+    def write(self, data) -> None:
+        """
+        Appends data, which may be any object accepted by :func:`frame_to_hyper`.
+        """
+        self._writer.write(_get_capsule_from_obj(data))
+
+    def flush(self) -> None:
+        """
+        Commits the rows written so far.
+        """
+        self._writer.flush()
+
+    def close(self) -> None:
+        """
+        Commits any pending rows and closes the connection.
+        """
+        self._writer.close(commit=True)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self._writer.close(commit=exc_type is None)
+
+
+def _expand_file_paths(paths) -> list[str]:
+    """Expands globs, returning absolute paths since hyperd resolves them"""
+    if isinstance(paths, (str, pathlib.Path)):
+        paths = [paths]
+
+    result = []
+    for path in paths:
+        matches = sorted(glob.glob(str(path)))
+        if not matches:
+            raise FileNotFoundError(f"No files found matching '{path}'")
+        result.extend(str(pathlib.Path(match).resolve()) for match in matches)
+
+    return result
+
+
+_FILE_FORMATS = {
+    ".parquet": "parquet",
+    ".pq": "parquet",
+    ".csv": "csv",
+    ".arrows": "arrow",
+}
+
+
+def _infer_file_format(path: str) -> Literal["parquet", "csv", "arrow"]:
+    suffix = pathlib.Path(path).suffix.lower()
+    try:
+        return _FILE_FORMATS[suffix]  # type: ignore[return-value]
+    except KeyError:
+        raise ValueError(
+            f"Could not infer file format from '{path}'; please provide 'format'"
+        ) from None
+
+
+def _read_file_schema(path: str, format: Literal["parquet", "csv", "arrow"]):
+    """Reads the schema of a file without loading its data"""
+    if format == "parquet":
+        import pyarrow.parquet as pq
+
+        return pq.read_schema(path)
+    elif format == "csv":
+        import pyarrow.csv as pa_csv
+
+        # types are inferred from the first block only
+        with pa_csv.open_csv(path) as reader:
+            return reader.schema
+    elif format == "arrow":
+        with pa.ipc.open_stream(path) as reader:
+            return reader.schema
+
+    raise ValueError("'format' must be one of 'parquet', 'csv' or 'arrow'")
+
+
+# names of the formats in Hyper's external() table function
+_HYPER_FILE_FORMATS = {"parquet": "parquet", "csv": "csv", "arrow": "arrowstream"}
+
+
+def file_to_hyper(
+    paths: Union[str, pathlib.Path, list[Union[str, pathlib.Path]]],
+    database: Union[str, pathlib.Path],
+    *,
+    table: pt_types.TableNameType,
+    format: Optional[Literal["parquet", "csv", "arrow"]] = None,
+    table_mode: Literal["a", "w"] = "w",
+    not_null_columns: Optional[set[str]] = None,
+    json_columns: Optional[set[str]] = None,
+    geo_columns: Optional[set[str]] = None,
+    process_params: Optional[dict[str, str]] = None,
+    atomic: bool = True,
+    session: Optional[Session] = None,
+    statistics: Union[bool, Literal["rescan"]] = False,
+    statistics_sidecar: Optional[Union[str, pathlib.Path]] = None,
+) -> None:
+    """
+    Loads files directly into a .hyper extract, without reading them in Python.
+
+    :param paths: Path, glob or list of paths / globs of the files to load. All files must share the same schema.
+    :param database: Name / location of the Hyper file to write to.
+    :param table: Table to write to.
+    :param format: One of "parquet", "csv" (with a header row) or "arrow" (Arrow IPC stream format). By default this is inferred from the extension of the first file.
+    :param table_mode: The mode to open the table with. Default is "w" for write, which truncates the file before writing. Another option is "a", which will append data to the file if it already contains information.
+    :param not_null_columns: Columns which should be considered "NOT NULL" in the target Hyper database. By default, all columns are considered nullable
+    :param json_columns: Columns to be written as a JSON data type
+    :param geo_columns: Columns to be written as a GEOGRAPHY data type
+    :param process_params: Parameters to pass to the Hyper Process constructor.
+    :param atomic: Whether to treat write as atomic. Appends to an existing file run in a single Hyper transaction, while overwrites are written to a temporary file that replaces the original once complete. Disabling gives better performance, but failures during write will likely corrupt the Hyper file.
+    :param session: A running :class:`pantab.Session` to write through, rather than starting a new Hyper process. Cannot be combined with ``process_params``.
+    :param statistics: Whether to record per-column statistics of each written table inside the file, which can be read back with :func:`statistics_from_hyper`. With ``True``, the row count, null count and minimum / maximum value of every column are collected while rows are inserted and added to the statistics recorded by earlier writes, without reading the table; each write is also recorded as a row range of its own. Appending to a table which has rows but no recorded statistics raises. Rows replaced by ``table_mode="m"`` are subtracted from the counts, but minimum / maximum values then only bound the remaining rows. ``"rescan"`` instead aggregates every column over the whole table after the write, which also yields approximate distinct counts but costs a full scan of each table on every write. Writes without statistics discard those recorded for their tables. Hyper reports nothing about the rows it loads, so collecting statistics reads the files a second time.
+    :param statistics_sidecar: Path of a JSON file to also write the statistics of the file to once the write completes, which :func:`statistics_from_sidecar` reads without starting Hyper. Requires ``statistics``.
+    """
+    _validate_table_mode(table_mode)
+
+    files = _expand_file_paths(paths)
+    if format is None:
+        format = _infer_file_format(files[0])
+    if format not in _HYPER_FILE_FORMATS:
+        raise ValueError("'format' must be one of 'parquet', 'csv' or 'arrow'")
+    statistics_mode = _to_statistics_mode(statistics)
+    _validate_statistics_sidecar(statistics, statistics_sidecar)
+
+    schema = _read_file_schema(files[0], format)
+
+    if not_null_columns is None:
+        not_null_columns = set()
+    if json_columns is None:
+        json_columns = set()
+    if geo_columns is None:
+        geo_columns = set()
+    native_session = _get_native_session(session, process_params)
+    if process_params is None:
+        process_params = {}
+
+    with _atomic_database_path(
+        database, table_mode, atomic, native_session
+    ) as (path_to_write, transactional):
+        libpantab.copy_to_hyper(
+            {_convert_to_table_name(table): (schema.__arrow_c_schema__(), files)},
+            path=str(path_to_write),
+            format=_HYPER_FILE_FORMATS[format],
+            table_mode=table_mode,
+            not_null_columns=not_null_columns,
+            json_columns=json_columns,
+            geo_columns=geo_columns,
+            process_params=process_params,
+            transactional=transactional,
+            statistics=statistics_mode,
+            session=native_session,
+        )
+
+    _write_sidecar(database, statistics_sidecar, process_params, session)
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Hyper and Arrow both store decimals as unscaled two's complement integers,
+// so values cross the Hyper API boundary without any text conversion. These
+// helpers translate between Arrow's native-endian word storage and a
+// (low, high) word pair that maps onto Hyper's raw numeric representation,
+// and check that a value fits the precision it is declared with, which
+// neither Arrow producers nor Hyper's raw constructors guarantee.
+namespace decimal_codec {
+
+struct Decimal128 {
+  uint64_t low;
+  uint64_t high;
+};
+
+// Arrow stores decimal128 values as two native-endian 64-bit words
+using Decimal128Storage = std::array<uint64_t, 2>;
+
+inline auto FromStorage(const Decimal128Storage &storage) -> Decimal128 {
+  if constexpr (std::endian::native == std::endian::little) {
+    return {std::get<0>(storage), std::get<1>(storage)};
+  } else {
+    return {std::get<1>(storage), std::get<0>(storage)};
+  }
+}
+
+inline auto ToStorage(const Decimal128 &value) -> Decimal128Storage {
+  if constexpr (std::endian::native == std::endian::little) {
+    return {value.low, value.high};
+  } else {
+    return {value.high, value.low};
+  }
+}
+
+// the widest precision Hyper numerics support, and the widest whose unscaled
+// values Hyper stores in 64 bits
+inline constexpr int32_t MaxPrecision = 38;
+inline constexpr int32_t MaxInt64Precision = 18;
+
+namespace detail {
+inline constexpr int HalfWordBits = 32;
+inline constexpr uint64_t HalfWordMask = 0xFFFF'FFFF;
+inline constexpr uint64_t Radix = 10;
+
+constexpr auto TimesTen(const Decimal128 &value) -> Decimal128 {
+  const uint64_t low_low = (value.low & HalfWordMask) * Radix;
+  const uint64_t low_high = (value.low >> HalfWordBits) * Radix +
+                            (low_low >> HalfWordBits);
+  return {(low_high << HalfWordBits) | (low_low & HalfWordMask),
+          value.high * Radix + (low_high >> HalfWordBits)};
+}
+
+// powers of ten as unsigned 128-bit values, indexed by exponent
+inline constexpr auto Pow10 = [] {
+  std::array<Decimal128, MaxPrecision + 1> table{};
+  const std::span powers{table};
+  powers[0] = {1, 0};
+  for (size_t i = 1; i < powers.size(); i++) {
+    powers[i] = TimesTen(powers[i - 1]);
+  }
+  return table;
+}();
+
+inline auto IsNegative(const Decimal128 &value) -> bool {
+  return static_cast<int64_t>(value.high) < 0;
+}
+
+// the absolute value as an unsigned 128-bit value
+inline auto Magnitude(const Decimal128 &value) -> Decimal128 {
+  if (!IsNegative(value)) {
+    return value;
+  }
+  return {~value.low + 1, ~value.high + (value.low == 0 ? 1 : 0)};
+}
+} // namespace detail
+
+///
+/// Whether an unscaled value has at most precision digits, i.e. whether
+/// |value| < 10^precision. Precision must lie in [0, MaxPrecision].
+///
+inline auto FitsPrecision(const Decimal128 &value, int32_t precision)
+    -> bool {
+  const std::span powers{detail::Pow10};
+  const auto &limit = powers[static_cast<size_t>(precision)];
+  if (precision <= MaxInt64Precision) {
+    // the high word must only carry the sign of the low word
+    const uint64_t sign_extension =
+        static_cast<int64_t>(value.low) < 0 ? ~uint64_t{0} : 0;
+    if (value.high != sign_extension) {
+      return false;
+    }
+    const uint64_t magnitude =
+        static_cast<int64_t>(value.low) < 0 ? 0 - value.low : value.low;
+    return magnitude < limit.low;
+  }
+
+  const auto magnitude = detail::Magnitude(value);
+  return magnitude.high < limit.high ||
+         (magnitude.high == limit.high && magnitude.low < limit.low);
+}
+
+///
+/// Orders unscaled values of the same scale
+///
+inline auto Less(const Decimal128 &lhs, const Decimal128 &rhs) -> bool {
+  const auto lhs_high = static_cast<int64_t>(lhs.high);
+  const auto rhs_high = static_cast<int64_t>(rhs.high);
+  return lhs_high < rhs_high || (lhs_high == rhs_high && lhs.low < rhs.low);
+}
+
+} // namespace decimal_codec
@@ -1,15 +1,49 @@
+#include <optional>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <hyperapi/hyperapi.hpp>
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/vector.h>
 
 #include "reader.hpp"
+#include "session.hpp"
 #include "writer.hpp"
 
 namespace nb = nanobind;
 
 NB_MODULE(libpantab, m) { // NOLINT
+  nb::class_<Session>(m, "Session")
+      .def(nb::init<std::unordered_map<std::string, std::string>>(),
+           nb::arg("process_params"),
+           nb::call_guard<nb::gil_scoped_release>())
+      .def(
+          "close",
+          [](Session &self) {
+            auto state = self.Release();
+            // shutting down hyperd does not touch Python
+            const nb::gil_scoped_release release{};
+            state.reset();
+          })
+      .def("drop_connections", &Session::DropConnections, nb::arg("path"),
+           nb::call_guard<nb::gil_scoped_release>());
+
+  nb::class_<TableWriter>(m, "TableWriter")
+      .def(nb::init<const std::string &, const nb::handle &,
+                    const std::string &, const nb::iterable,
+                    const nb::iterable, const nb::iterable,
+                    std::unordered_map<std::string, std::string>, size_t,
+                    size_t, const Session *>(),
+           nb::arg("path"), nb::arg("table"), nb::arg("table_mode"),
+           nb::arg("not_null_columns"), nb::arg("json_columns"),
+           nb::arg("geo_columns"), nb::arg("process_params"),
+           nb::arg("flush_rows"), nb::arg("flush_bytes"),
+           nb::arg("session").none())
+      .def("write", &TableWriter::Write, nb::arg("capsule"))
+      .def("flush", &TableWriter::Flush)
+      .def("close", &TableWriter::Close, nb::arg("commit"));
+
   m.def("escape_sql_identifier",
         [](const nb::str &str) {
           const auto required_size =
@@ -19,41 +53,73 @@ NB_MODULE(libpantab, m) { // NOLINT
                                      nb::len(str));
           return result;
         })
+      .def("escape_sql_string_literal",
+           [](const std::string &str) {
+             return hyperapi::escapeStringLiteral(str);
+           })
       .def(
           "get_table_names",
-          [](const std::string &path) {
-            std::unordered_map<std::string, std::string> params{
-                {"log_config", ""}};
-            const hyperapi::HyperProcess hyper{
-                hyperapi::Telemetry::DoNotSendUsageDataToTableau, "",
-                std::move(params)};
-            hyperapi::Connection connection(hyper.getEndpoint(), path);
+          [](const std::string &path, const Session *session) {
+            // schema name (if any) and table name of each table
+            std::vector<std::pair<std::optional<std::string>, std::string>>
+                table_names;
+            auto session_state = GetSessionState(session);
+            {
+              const nb::gil_scoped_release release{};
+              const auto hyper =
+                  GetOrCreateSession(std::move(session_state), {});
+              PooledConnection pooled{hyper, path};
+              auto &connection = pooled.Get();
 
-            nb::list result;
-            for (const auto &schema_name :
-                 connection.getCatalog().getSchemaNames()) {
-              for (const auto &table_name :
-                   connection.getCatalog().getTableNames(schema_name)) {
-                const auto schema_prefix = table_name.getSchemaName();
-                if (schema_prefix) {
-                  const auto tup =
-                      nb::make_tuple(schema_prefix->getName().getUnescaped(),
-                                     table_name.getName().getUnescaped());
-                  result.append(tup);
-                } else {
-                  result.append(
-                      nb::str(table_name.getName().getUnescaped().c_str()));
+              for (const auto &schema_name :
+                   connection.getCatalog().getSchemaNames()) {
+                for (const auto &table_name :
+                     connection.getCatalog().getTableNames(schema_name)) {
+                  const auto schema_prefix = table_name.getSchemaName();
+                  table_names.emplace_back(
+                      schema_prefix ? std::optional{schema_prefix->getName()
+                                                        .getUnescaped()}
+                                    : std::nullopt,
+                      table_name.getName().getUnescaped());
                 }
               }
             }
 
+            nb::list result;
+            for (const auto &[schema_prefix, table_name] : table_names) {
+              if (schema_prefix) {
+                const auto tup = nb::make_tuple(*schema_prefix, table_name);
+                result.append(tup);
+              } else {
+                result.append(nb::str(table_name.c_str()));
+              }
+            }
+
             return result;
           },
-          nb::arg("path"))
+          nb::arg("path"), nb::arg("session").none())
       .def("write_to_hyper", &write_to_hyper, nb::arg("dict_of_capsules"),
            nb::arg("path"), nb::arg("table_mode"), nb::arg("not_null_columns"),
            nb::arg("json_columns"), nb::arg("geo_columns"),
-           nb::arg("process_params"))
+           nb::arg("process_params"), nb::arg("queue_depth"),
+           nb::arg("max_workers"), nb::arg("shards"), nb::arg("key_columns"),
+           nb::arg("transactional"), nb::arg("checkpoint_key"),
+           nb::arg("checkpoint_rows"), nb::arg("checkpoint_bytes"),
+           nb::arg("statistics"), nb::arg("session").none())
+      .def("write_partitioned_to_hyper", &write_partitioned_to_hyper,
+           nb::arg("capsule"), nb::arg("path"), nb::arg("table"),
+           nb::arg("partition_column"), nb::arg("table_mode"),
+           nb::arg("not_null_columns"), nb::arg("json_columns"),
+           nb::arg("geo_columns"), nb::arg("process_params"),
+           nb::arg("queue_depth"), nb::arg("max_open_partitions"),
+           nb::arg("session").none())
+      .def("copy_to_hyper", &copy_to_hyper, nb::arg("dict_of_sources"),
+           nb::arg("path"), nb::arg("format"), nb::arg("table_mode"),
+           nb::arg("not_null_columns"), nb::arg("json_columns"),
+           nb::arg("geo_columns"), nb::arg("process_params"),
+           nb::arg("transactional"), nb::arg("statistics"),
+           nb::arg("session").none())
       .def("read_from_hyper_query", &read_from_hyper_query, nb::arg("path"),
-           nb::arg("query"), nb::arg("process_params"), nb::arg("chunk_size"));
+           nb::arg("query"), nb::arg("process_params"), nb::arg("chunk_size"),
+           nb::arg("queue_depth"), nb::arg("session").none());
 }
@@ -1,18 +1,82 @@
 from typing import Any, Literal, Optional
 
+class Session:
+    def __init__(self, process_params: dict[str, str]) -> None: ...
+    def close(self) -> None: ...
+    def drop_connections(self, path: str) -> None: ...
+
+class TableWriter:
+    def __init__(
+        self,
+        path: str,
+        table: Any,
+        table_mode: Literal["w", "a"],
+        not_null_columns: set[str],
+        json_columns: set[str],
+        geo_columns: set[str],
+        process_params: dict[str, str],
+        flush_rows: int,
+        flush_bytes: int,
+        session: Optional[Session],
+    ) -> None: ...
+    def write(self, capsule: Any) -> None: ...
+    def flush(self) -> None: ...
+    def close(self, commit: bool) -> None: ...
+
 def write_to_hyper(
     dict_of_capsules: dict[tuple[str, str], Any],
     path: str,
+    table_mode: Literal["w", "a", "m"],
+    not_null_columns: set[str],
+    json_columns: set[str],
+    geo_columns: set[str],
+    process_params: Optional[dict[str, str]],
+    queue_depth: int,
+    max_workers: int,
+    shards: int,
+    key_columns: list[str],
+    transactional: bool,
+    checkpoint_key: str,
+    checkpoint_rows: int,
+    checkpoint_bytes: int,
+    statistics: str,
+    session: Optional[Session],
+) -> None: ...
+def write_partitioned_to_hyper(
+    capsule: Any,
+    path: str,
+    table: Any,
+    partition_column: str,
+    table_mode: Literal["w", "a"],
+    not_null_columns: set[str],
+    json_columns: set[str],
+    geo_columns: set[str],
+    process_params: Optional[dict[str, str]],
+    queue_depth: int,
+    max_open_partitions: int,
+    session: Optional[Session],
+) -> None: ...
+def copy_to_hyper(
+    dict_of_sources: dict[tuple[str, str], tuple[Any, list[str]]],
+    path: str,
+    format: str,
     table_mode: Literal["w", "a"],
     not_null_columns: set[str],
     json_columns: set[str],
     geo_columns: set[str],
     process_params: Optional[dict[str, str]],
+    transactional: bool,
+    statistics: str,
+    session: Optional[Session],
 ) -> None: ...
 def read_from_hyper_query(
     path: str,
     query: str,
     process_params: Optional[dict[str, str]],
+    chunk_size: int,
+    queue_depth: int,
+    session: Optional[Session],
 ) -> Any: ...
 def escape_sql_identifier(str: str) -> str: ...
-def get_table_names(path: str) -> list[str]: ...
+def escape_sql_string_literal(str: str) -> str: ...
+def get_table_names(path: str, session: Optional[Session]) -> list[str]: ...
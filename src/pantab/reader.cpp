@@ -1,7 +1,20 @@
 #include "reader.hpp"
-#include "numeric_gen.hpp"
-
+#include "decimal_codec.hpp"
+#include "session.hpp"
+#include "temporal.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <span>
+#include <thread>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
@@ -14,361 +27,443 @@ namespace gsl {
 template <typename T> using owner = T;
 }
 
-class ReadHelper {
+///
+/// Throws the message of a Hyper C API error, if there is one, after
+/// releasing it
+///
+static auto ThrowIfHyperError(hyper_error_t *error) -> void {
+  if (error == nullptr) {
+    return;
+  }
+
+  std::string message{"Hyper API call failed"};
+  hyper_error_field_value value{};
+  if (hyper_error_get_field(error, HYPER_ERROR_FIELD_MESSAGE, &value) ==
+          nullptr &&
+      value.value.string != nullptr) {
+    message = value.value.string;
+  }
+  hyper_error_destroy(error);
+  throw std::runtime_error(message);
+}
+
+///
+/// A chunk of a result set fetched through the Hyper C API. Unlike
+/// hyperapi::Chunk this exposes the raw field buffers, so a column can be
+/// copied without materializing a hyperapi::Row or Value per cell. The
+/// field for (row, column) lives at index row * column_count + column.
+///
+class RawChunk {
 public:
-  ReadHelper(struct ArrowArray *array) : array_(array) {}
-  ReadHelper(const ReadHelper &) = delete;
-  ReadHelper &operator=(ReadHelper &) = delete;
-  ReadHelper(ReadHelper &&) = delete;
-  ReadHelper &operator=(ReadHelper &&) = delete;
+  explicit RawChunk(hyper_rowset_chunk_t *chunk) : chunk_(chunk) {
+    const uint8_t *const *values{};
+    const size_t *sizes{};
+    const int8_t *null_flags{};
+    if (auto *error = hyper_rowset_chunk_field_values(
+            chunk_, &ncols_, &nrows_, &values, &sizes, &null_flags)) {
+      hyper_destroy_rowset_chunk(chunk_);
+      ThrowIfHyperError(error);
+    }
 
-  virtual ~ReadHelper() = default;
-  virtual auto Read(const hyperapi::Value &) -> void = 0;
+    const auto nfields = ncols_ * nrows_;
+    values_ = {values, nfields};
+    sizes_ = {sizes, nfields};
+    null_flags_ = {null_flags, nfields};
+  }
 
-protected:
-  auto GetMutableArray() { return array_; }
+  RawChunk(const RawChunk &) = delete;
+  auto operator=(const RawChunk &) -> RawChunk & = delete;
+  RawChunk(RawChunk &&) = delete;
+  auto operator=(RawChunk &&) -> RawChunk & = delete;
 
-private:
-  struct ArrowArray *array_;
-};
+  ~RawChunk() { hyper_destroy_rowset_chunk(chunk_); }
 
-template <typename T> class IntegralReadHelper : public ReadHelper {
-  using ReadHelper::ReadHelper;
+  [[nodiscard]] auto GetRowCount() const noexcept { return nrows_; }
 
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
-      }
-      return;
-    }
-    if (ArrowArrayAppendInt(GetMutableArray(), value.get<T>())) {
-      throw std::runtime_error("ArrowAppendInt failed");
-    };
+  [[nodiscard]] auto IsNull(size_t row, hyper_field_index_t column) const
+      -> bool {
+    return null_flags_[Index(row, column)] != 0;
   }
-};
-
-class OidReadHelper : public ReadHelper {
-  using ReadHelper::ReadHelper;
 
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
-      }
-      return;
-    }
-    if (ArrowArrayAppendUInt(GetMutableArray(), value.get<uint32_t>())) {
-      throw std::runtime_error("ArrowAppendUInt failed");
-    };
+  [[nodiscard]] auto GetField(size_t row, hyper_field_index_t column) const
+      -> std::span<const uint8_t> {
+    const auto idx = Index(row, column);
+    return {values_[idx], sizes_[idx]};
   }
-};
 
-template <typename T> class FloatReadHelper : public ReadHelper {
-  using ReadHelper::ReadHelper;
+  ///
+  /// Reads a fixed-width field in its raw Hyper representation
+  ///
+  template <typename T>
+  [[nodiscard]] auto Read(size_t row, hyper_field_index_t column) const -> T {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value{};
+    std::memcpy(&value, values_[Index(row, column)], sizeof(T));
+    return value;
+  }
 
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
-      }
-      return;
-    }
-    if (ArrowArrayAppendDouble(GetMutableArray(), value.get<T>())) {
-      throw std::runtime_error("ArrowAppendDouble failed");
-    };
+private:
+  [[nodiscard]] auto Index(size_t row, hyper_field_index_t column) const
+      -> size_t {
+    return row * ncols_ + column;
   }
-};
 
-class BooleanReadHelper : public ReadHelper {
-  using ReadHelper::ReadHelper;
+  hyper_rowset_chunk_t *chunk_;
+  size_t ncols_{};
+  size_t nrows_{};
+  std::span<const uint8_t *const> values_;
+  std::span<const size_t> sizes_;
+  std::span<const int8_t> null_flags_;
+};
 
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
-      }
-      return;
-    }
-    if (ArrowArrayAppendInt(GetMutableArray(), value.get<bool>())) {
-      throw std::runtime_error("ArrowAppendBool failed");
-    };
+///
+/// Owns a result set fetched through the Hyper C API
+///
+class Rowset {
+public:
+  Rowset(hyperapi::Connection &connection, const std::string &query) {
+    ThrowIfHyperError(hyper_execute_query(
+        hyperapi::internal::getHandle(connection), query.c_str(), &rowset_));
   }
-};
 
-class BytesReadHelper : public ReadHelper {
-  using ReadHelper::ReadHelper;
+  Rowset(const Rowset &) = delete;
+  auto operator=(const Rowset &) -> Rowset & = delete;
+  Rowset(Rowset &&) = delete;
+  auto operator=(Rowset &&) -> Rowset & = delete;
 
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
-      }
-      return;
+  ~Rowset() {
+    if (rowset_ != nullptr) {
+      hyper_close_rowset(rowset_);
     }
+  }
 
-    // TODO: we can use the non-owning hyperapi::ByteSpan template type but
-    // there is a bug in that header file that needs an upstream fix first
-    const auto bytes = value.get<std::vector<uint8_t>>();
-    const ArrowBufferView arrow_buffer_view{{bytes.data()},
-                                            static_cast<int64_t>(bytes.size())};
+  [[nodiscard]] auto GetTableDefinition() const
+      -> const hyper_table_definition_t * {
+    return hyper_rowset_get_table_definition(rowset_);
+  }
 
-    if (ArrowArrayAppendBytes(GetMutableArray(), arrow_buffer_view)) {
-      throw std::runtime_error("ArrowAppendString failed");
-    };
+  ///
+  /// Returns the next chunk, or nullptr once the result is exhausted. The
+  /// caller takes ownership of the chunk.
+  ///
+  auto FetchNextChunk() -> hyper_rowset_chunk_t * {
+    hyper_rowset_chunk_t *chunk = nullptr;
+    ThrowIfHyperError(hyper_rowset_get_next_chunk(rowset_, &chunk));
+    return chunk;
   }
-};
 
-class StringReadHelper : public ReadHelper {
-  using ReadHelper::ReadHelper;
+private:
+  hyper_rowset_t *rowset_{};
+};
 
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
-      }
-      return;
+///
+/// Sizes one child array's buffers for a whole chunk up front. Every slot
+/// starts out valid; decoders clear the bits of the nulls they encounter.
+///
+class ColumnBuilder {
+public:
+  ColumnBuilder(struct ArrowArray *array, size_t nrows)
+      : array_(array), nrows_(nrows) {
+    struct ArrowBitmap *bitmap = ArrowArrayValidityBitmap(array_);
+    if (ArrowBitmapReserve(bitmap, static_cast<int64_t>(nrows_))) {
+      throw std::runtime_error("Could not reserve validity bitmap");
     }
-
-#if defined(_WIN32) && defined(_MSC_VER)
-    const auto strval = value.get<std::string>();
-    const ArrowStringView arrow_string_view{
-        strval.c_str(), static_cast<int64_t>(strval.size())};
-#else
-    const auto strval = value.get<std::string_view>();
-    const ArrowStringView arrow_string_view{
-        strval.data(), static_cast<int64_t>(strval.size())};
-#endif
-
-    if (ArrowArrayAppendString(GetMutableArray(), arrow_string_view)) {
-      throw std::runtime_error("ArrowAppendString failed");
-    };
+    ArrowBitmapAppendUnsafe(bitmap, 1, static_cast<int64_t>(nrows_));
   }
-};
 
-class DateReadHelper : public ReadHelper {
-  using ReadHelper::ReadHelper;
-
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
-      }
-      return;
+  [[nodiscard]] auto GetRowCount() const noexcept { return nrows_; }
+
+  ///
+  /// Resizes buffer i to hold count elements of T and returns them
+  ///
+  template <typename T>
+  auto ResizeBuffer(int64_t i, size_t count) -> std::span<T> {
+    struct ArrowBuffer *buffer = ArrowArrayBuffer(array_, i);
+    if (ArrowBufferResize(buffer, static_cast<int64_t>(count * sizeof(T)),
+                          false)) {
+      throw std::runtime_error("Could not resize Arrow buffer");
     }
+    return {static_cast<T *>(static_cast<void *>(buffer->data)), count};
+  }
 
-    // TODO: need some bounds /overflow checking
-    // tableau uses uint32 but we have int32
-    constexpr int32_t tableau_to_unix_days = 2440588;
-    const auto hyper_date = value.get<hyperapi::Date>();
-    const auto raw_value = static_cast<int32_t>(hyper_date.getRaw());
-    const auto arrow_value = raw_value - tableau_to_unix_days;
+  auto GetBuffer(int64_t i) -> struct ArrowBuffer * {
+    return ArrowArrayBuffer(array_, i);
+  }
 
-    auto array = GetMutableArray();
-    struct ArrowBuffer *data_buffer = ArrowArrayBuffer(array, 1);
-    if (ArrowBufferAppendInt32(data_buffer, arrow_value)) {
-      throw std::runtime_error("Failed to append date32 value");
-    }
+  auto SetNull(size_t i) -> void {
+    ArrowBitClear(ArrowArrayValidityBitmap(array_)->buffer.data,
+                  static_cast<int64_t>(i));
+    null_count_++;
+  }
 
-    struct ArrowBitmap *validity_bitmap = ArrowArrayValidityBitmap(array);
-    if (ArrowBitmapAppend(validity_bitmap, true, 1)) {
-      throw std::runtime_error("Could not append validity buffer for date32");
-    };
-    array->length++;
+  auto Finish() -> void {
+    array_->length = static_cast<int64_t>(nrows_);
+    array_->null_count = null_count_;
   }
+
+private:
+  struct ArrowArray *array_;
+  size_t nrows_;
+  int64_t null_count_{};
 };
 
-template <bool TZAware> class DatetimeReadHelper : public ReadHelper {
-  using ReadHelper::ReadHelper;
+///
+/// The raw representation Hyper uses for a fixed-width type
+///
+template <typename T> struct HyperStorage {
+  using type = T;
+};
+template <> struct HyperStorage<hyperapi::Date> {
+  using type = hyper_date_t;
+};
+template <> struct HyperStorage<hyperapi::Time> {
+  using type = hyper_time_t;
+};
+template <> struct HyperStorage<hyperapi::Timestamp> {
+  using type = hyper_timestamp_t;
+};
+template <> struct HyperStorage<hyperapi::OffsetTimestamp> {
+  using type = hyper_timestamp_t;
+};
 
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
+///
+/// Decodes a column of fixed-width Hyper values into an Arrow data buffer.
+/// Temporal types are copied in their raw Hyper representation and shifted
+/// to the Unix epoch in one pass over the whole buffer.
+///
+template <typename HyperT, typename ArrowT> class FixedWidthDecoder {
+public:
+  auto Decode(const RawChunk &chunk, hyper_field_index_t column,
+              ColumnBuilder &builder) const -> void {
+    using StorageT = typename HyperStorage<HyperT>::type;
+    static_assert(sizeof(StorageT) == sizeof(ArrowT));
+
+    const auto nrows = builder.GetRowCount();
+    const auto values = builder.ResizeBuffer<ArrowT>(1, nrows);
+    for (size_t i = 0; i < nrows; i++) {
+      if (chunk.IsNull(i, column)) {
+        values[i] = ArrowT{};
+        builder.SetNull(i);
+      } else {
+        values[i] = static_cast<ArrowT>(chunk.Read<StorageT>(i, column));
       }
-      return;
     }
 
-    using timestamp_t =
-        typename std::conditional<TZAware, hyperapi::OffsetTimestamp,
-                                  hyperapi::Timestamp>::type;
-    const auto hyper_ts = value.get<timestamp_t>();
-
-    // TODO: need some bounds /overflow checking
-    // tableau uses uint64 but we have int64
-    constexpr int64_t tableau_to_unix_usec =
-        2440588LL * 24 * 60 * 60 * 1000 * 1000;
-    const auto raw_usec = static_cast<int64_t>(hyper_ts.getRaw());
-    const auto arrow_value = raw_usec - tableau_to_unix_usec;
-
-    auto array = GetMutableArray();
-    struct ArrowBuffer *data_buffer = ArrowArrayBuffer(array, 1);
-    if (ArrowBufferAppendInt64(data_buffer, arrow_value)) {
-      throw std::runtime_error("Failed to append timestamp64 value");
+    if constexpr (std::is_same_v<HyperT, hyperapi::Date>) {
+      temporal::FromJulianDays(values);
+    } else if constexpr (std::is_same_v<HyperT, hyperapi::Timestamp> ||
+                         std::is_same_v<HyperT, hyperapi::OffsetTimestamp>) {
+      temporal::FromJulianMicroseconds(values);
     }
-
-    struct ArrowBitmap *validity_bitmap = ArrowArrayValidityBitmap(array);
-    if (ArrowBitmapAppend(validity_bitmap, true, 1)) {
-      throw std::runtime_error(
-          "Could not append validity buffer for timestamp");
-    };
-    array->length++;
   }
 };
 
-class TimeReadHelper : public ReadHelper {
-  using ReadHelper::ReadHelper;
-
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
+class BooleanDecoder {
+public:
+  auto Decode(const RawChunk &chunk, hyper_field_index_t column,
+              ColumnBuilder &builder) const -> void {
+    const auto nrows = builder.GetRowCount();
+    const auto bits = builder.ResizeBuffer<uint8_t>(
+        1, static_cast<size_t>(_ArrowBytesForBits(
+               static_cast<int64_t>(nrows))));
+    std::fill(bits.begin(), bits.end(), uint8_t{0});
+    for (size_t i = 0; i < nrows; i++) {
+      if (chunk.IsNull(i, column)) {
+        builder.SetNull(i);
+      } else if (chunk.Read<uint8_t>(i, column) != 0) {
+        ArrowBitSet(bits.data(), static_cast<int64_t>(i));
       }
-      return;
-    }
-
-    const auto time = value.get<hyperapi::Time>();
-    const auto raw_value = time.getRaw();
-    if (ArrowArrayAppendInt(GetMutableArray(),
-                            static_cast<int64_t>(raw_value))) {
-      throw std::runtime_error("ArrowAppendInt failed");
     }
   }
 };
 
-class IntervalReadHelper : public ReadHelper {
-  using ReadHelper::ReadHelper;
+///
+/// Decodes text or binary values into large (64-bit offset) Arrow arrays.
+/// Values are copied straight from the chunk's field buffers: a first pass
+/// computes the offsets, and with them the chunk's exact data size, and a
+/// second copies each value once into a data buffer of that size.
+///
+class VarBinaryDecoder {
+public:
+  auto Decode(const RawChunk &chunk, hyper_field_index_t column,
+              ColumnBuilder &builder) const -> void {
+    const auto nrows = builder.GetRowCount();
+    const auto offsets = builder.ResizeBuffer<int64_t>(1, nrows + 1);
+    offsets[0] = 0;
+    for (size_t i = 0; i < nrows; i++) {
+      int64_t size = 0;
+      if (chunk.IsNull(i, column)) {
+        builder.SetNull(i);
+      } else {
+        size = static_cast<int64_t>(chunk.GetField(i, column).size());
+      }
+      offsets[i + 1] = offsets[i] + size;
+    }
 
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
+    const auto data =
+        builder.ResizeBuffer<uint8_t>(2, static_cast<size_t>(offsets[nrows]));
+    for (size_t i = 0; i < nrows; i++) {
+      if (offsets[i + 1] == offsets[i]) {
+        continue;
       }
-      return;
+      const auto field = chunk.GetField(i, column);
+      std::copy(field.begin(), field.end(),
+                data.begin() + static_cast<std::ptrdiff_t>(offsets[i]));
     }
+  }
+};
 
-    struct ArrowInterval arrow_interval {};
-    ArrowIntervalInit(&arrow_interval, NANOARROW_TYPE_INTERVAL_MONTH_DAY_NANO);
-    const auto interval_value = value.get<hyperapi::Interval>();
+class IntervalDecoder {
+public:
+  auto Decode(const RawChunk &chunk, hyper_field_index_t column,
+              ColumnBuilder &builder) const -> void {
     constexpr auto MonthsPerYear = 12;
     constexpr auto NsPerHour = 3'600'000'000'000LL;
     constexpr auto NsPerMin = 60'000'000'000LL;
     constexpr auto NsPerSec = 1'000'000'000LL;
     constexpr auto NsPerUsec = 1'000LL;
 
-    arrow_interval.months =
-        interval_value.getYears() * MonthsPerYear + interval_value.getMonths();
-    arrow_interval.days = interval_value.getDays();
-    arrow_interval.ns = interval_value.getHours() * NsPerHour +
-                        interval_value.getMinutes() * NsPerMin +
-                        interval_value.getSeconds() * NsPerSec +
-                        interval_value.getMicroseconds() * NsPerUsec;
+    const auto nrows = builder.GetRowCount();
+    const auto values = builder.ResizeBuffer<MonthDayNano>(1, nrows);
+    for (size_t i = 0; i < nrows; i++) {
+      if (chunk.IsNull(i, column)) {
+        values[i] = MonthDayNano{};
+        builder.SetNull(i);
+        continue;
+      }
 
-    if (ArrowArrayAppendInterval(GetMutableArray(), &arrow_interval)) {
-      throw std::runtime_error("Failed to append interval value");
+      const hyperapi::Interval value{chunk.Read<hyper_interval_t>(i, column),
+                                     hyperapi::raw_t{}};
+      values[i] = {value.getYears() * MonthsPerYear + value.getMonths(),
+                   value.getDays(),
+                   value.getHours() * NsPerHour +
+                       value.getMinutes() * NsPerMin +
+                       value.getSeconds() * NsPerSec +
+                       value.getMicroseconds() * NsPerUsec};
     }
   }
+
+private:
+  // the layout of an Arrow month_day_nano interval value
+  struct MonthDayNano {
+    int32_t months;
+    int32_t days;
+    int64_t ns;
+  };
+  static_assert(sizeof(MonthDayNano) == 16);
 };
 
-class DecimalReadHelper : public ReadHelper {
+///
+/// Decodes numerics from their raw unscaled integers, which Hyper stores in
+/// 64 bits up to a precision of 18 and in 128 bits beyond that
+///
+class DecimalDecoder {
 public:
-  explicit DecimalReadHelper(struct ArrowArray *array, int32_t precision,
-                             int32_t scale)
-      : ReadHelper(array), precision_(precision), scale_(scale) {}
-
-  auto Read(const hyperapi::Value &value) -> void override {
-    if (value.isNull()) {
-      if (ArrowArrayAppendNull(GetMutableArray(), 1)) {
-        throw std::runtime_error("ArrowAppendNull failed");
-      }
-      return;
-    }
-
-    constexpr int32_t bitwidth = 128;
-    struct ArrowDecimal decimal {};
-    ArrowDecimalInit(&decimal, bitwidth, precision_, scale_);
-
-    constexpr auto PrecisionLimit = 39; // of-by-one error in solution?
-    if (precision_ >= PrecisionLimit) {
+  DecimalDecoder(int32_t precision, int32_t scale) {
+    // Hyper numerics hold at most 38 digits
+    constexpr auto MaxPrecision = 38;
+    if (precision > MaxPrecision) {
       throw nb::value_error("Numeric precision may not exceed 38!");
     }
-    if (scale_ >= PrecisionLimit) {
-      throw nb::value_error("Numeric scale may not exceed 38!");
+    if (scale > precision) {
+      throw nb::value_error("Numeric scale may not exceed precision!");
     }
+  }
 
-    const auto decimal_string = std::visit(
-        [&value](auto P, auto S) -> std::string {
-          if constexpr (S() <= P()) {
-            const auto decimal_value = value.get<hyperapi::Numeric<P(), S()>>();
-            auto value_string = decimal_value.toString();
-            std::erase(value_string, '.');
-            return value_string;
-          }
-          throw "unreachable";
-        },
-        to_integral_variant<PrecisionLimit>(precision_),
-        to_integral_variant<PrecisionLimit>(scale_));
-
-    const struct ArrowStringView sv {
-      decimal_string.data(), static_cast<int64_t>(decimal_string.size())
-    };
-
-    if (ArrowDecimalSetDigits(&decimal, sv)) {
-      throw std::runtime_error(
-          "Unable to convert tableau numeric to arrow decimal");
-    }
+  auto Decode(const RawChunk &chunk, hyper_field_index_t column,
+              ColumnBuilder &builder) const -> void {
+    const auto nrows = builder.GetRowCount();
+    const auto values =
+        builder.ResizeBuffer<decimal_codec::Decimal128Storage>(1, nrows);
+    for (size_t i = 0; i < nrows; i++) {
+      if (chunk.IsNull(i, column)) {
+        values[i] = decimal_codec::Decimal128Storage{};
+        builder.SetNull(i);
+        continue;
+      }
 
-    if (ArrowArrayAppendDecimal(GetMutableArray(), &decimal)) {
-      throw std::runtime_error("Failed to append decimal value");
+      values[i] = decimal_codec::ToStorage(ReadUnscaled(chunk, i, column));
     }
   }
 
 private:
-  int32_t precision_;
-  int32_t scale_;
+  static auto ReadUnscaled(const RawChunk &chunk, size_t row,
+                           hyper_field_index_t column)
+      -> decimal_codec::Decimal128 {
+    const auto width = chunk.GetField(row, column).size();
+    if (width == sizeof(int64_t)) {
+      const auto raw = chunk.Read<int64_t>(row, column);
+      // sign-extend into the high word
+      return {static_cast<uint64_t>(raw), raw < 0 ? ~uint64_t{0} : 0};
+    }
+    if (width == sizeof(hyper_data128_t)) {
+      // least significant word first
+      const auto raw = chunk.Read<hyper_data128_t>(row, column);
+      const std::span words{raw.data};
+      return {words[0], words[1]};
+    }
+
+    throw std::runtime_error("Unexpected numeric field width: " +
+                             std::to_string(width));
+  }
 };
 
-static auto MakeReadHelper(const ArrowSchemaView *schema_view,
-                           struct ArrowArray *array)
-    -> std::unique_ptr<ReadHelper> {
+using ColumnDecoderVariant =
+    std::variant<FixedWidthDecoder<int16_t, int16_t>,
+                 FixedWidthDecoder<int32_t, int32_t>,
+                 FixedWidthDecoder<int64_t, int64_t>,
+                 FixedWidthDecoder<uint32_t, uint32_t>,
+                 FixedWidthDecoder<float, float>,
+                 FixedWidthDecoder<double, double>,
+                 FixedWidthDecoder<hyperapi::Date, int32_t>,
+                 FixedWidthDecoder<hyperapi::Time, int64_t>,
+                 FixedWidthDecoder<hyperapi::Timestamp, int64_t>,
+                 FixedWidthDecoder<hyperapi::OffsetTimestamp, int64_t>,
+                 BooleanDecoder, VarBinaryDecoder, IntervalDecoder,
+                 DecimalDecoder>;
+
+template <typename DecoderT, typename... Args>
+static auto MakeDecoder(Args &&...args) -> ColumnDecoderVariant {
+  return ColumnDecoderVariant{std::in_place_type<DecoderT>,
+                              std::forward<Args>(args)...};
+}
+
+static auto MakeColumnDecoder(const ArrowSchemaView *schema_view)
+    -> ColumnDecoderVariant {
   switch (schema_view->type) {
   case NANOARROW_TYPE_INT16:
-    return std::unique_ptr<ReadHelper>(new IntegralReadHelper<int16_t>(array));
+    return MakeDecoder<FixedWidthDecoder<int16_t, int16_t>>();
   case NANOARROW_TYPE_INT32:
-    return std::unique_ptr<ReadHelper>(new IntegralReadHelper<int32_t>(array));
+    return MakeDecoder<FixedWidthDecoder<int32_t, int32_t>>();
   case NANOARROW_TYPE_INT64:
-    return std::unique_ptr<ReadHelper>(new IntegralReadHelper<int64_t>(array));
+    return MakeDecoder<FixedWidthDecoder<int64_t, int64_t>>();
   case NANOARROW_TYPE_UINT32:
-    return std::unique_ptr<ReadHelper>(new OidReadHelper(array));
+    return MakeDecoder<FixedWidthDecoder<uint32_t, uint32_t>>();
   case NANOARROW_TYPE_FLOAT:
-    return std::unique_ptr<ReadHelper>(new FloatReadHelper<float>(array));
+    return MakeDecoder<FixedWidthDecoder<float, float>>();
   case NANOARROW_TYPE_DOUBLE:
-    return std::unique_ptr<ReadHelper>(new FloatReadHelper<double>(array));
+    return MakeDecoder<FixedWidthDecoder<double, double>>();
   case NANOARROW_TYPE_LARGE_BINARY:
-    return std::unique_ptr<ReadHelper>(new BytesReadHelper(array));
   case NANOARROW_TYPE_LARGE_STRING:
-    return std::unique_ptr<ReadHelper>(new StringReadHelper(array));
+    return MakeDecoder<VarBinaryDecoder>();
   case NANOARROW_TYPE_BOOL:
-    return std::unique_ptr<ReadHelper>(new BooleanReadHelper(array));
+    return MakeDecoder<BooleanDecoder>();
   case NANOARROW_TYPE_DATE32:
-    return std::unique_ptr<ReadHelper>(new DateReadHelper(array));
+    return MakeDecoder<FixedWidthDecoder<hyperapi::Date, int32_t>>();
   case NANOARROW_TYPE_TIMESTAMP: {
     if (strcmp("", schema_view->timezone)) {
-      return std::unique_ptr<ReadHelper>(new DatetimeReadHelper<true>(array));
-    } else {
-      return std::unique_ptr<ReadHelper>(new DatetimeReadHelper<false>(array));
+      return MakeDecoder<
+          FixedWidthDecoder<hyperapi::OffsetTimestamp, int64_t>>();
     }
+    return MakeDecoder<FixedWidthDecoder<hyperapi::Timestamp, int64_t>>();
   }
   case NANOARROW_TYPE_INTERVAL_MONTH_DAY_NANO:
-    return std::unique_ptr<ReadHelper>(new IntervalReadHelper(array));
+    return MakeDecoder<IntervalDecoder>();
   case NANOARROW_TYPE_TIME64:
-    return std::unique_ptr<ReadHelper>(new TimeReadHelper(array));
-  case NANOARROW_TYPE_DECIMAL128: {
-    const auto precision = schema_view->decimal_precision;
-    const auto scale = schema_view->decimal_scale;
-    return std::unique_ptr<ReadHelper>(
-        new DecimalReadHelper(array, precision, scale));
-  }
+    return MakeDecoder<FixedWidthDecoder<hyperapi::Time, int64_t>>();
+  case NANOARROW_TYPE_DECIMAL128:
+    return MakeDecoder<DecimalDecoder>(schema_view->decimal_precision,
+                                       schema_view->decimal_scale);
   default:
     throw nb::type_error("unknownn arrow type provided");
   }
@@ -442,55 +537,51 @@ static auto SetSchemaTypeFromHyperType(struct ArrowSchema *schema,
   }
 }
 
-struct HyperResultIteratorPrivate {
-  HyperResultIteratorPrivate(hyperapi::HyperProcess process,
-                             hyperapi::Connection connection,
-                             std::unique_ptr<hyperapi::Result> result,
-                             hyperapi::ChunkedResultIterator iter)
-      : process_(std::move(process)), connection_(std::move(connection)),
-        result_(std::move(result)), iter_(std::move(iter)) {}
-
-  const hyperapi::HyperProcess process_;
-  hyperapi::Connection connection_;
-  std::unique_ptr<hyperapi::Result> result_;
-  hyperapi::ChunkedResultIterator iter_;
-  struct ArrowError error_ {};
-};
-
-static auto ReleaseArrowStream(void *ptr) noexcept -> void {
-  auto stream = static_cast<gsl::owner<ArrowArrayStream *>>(ptr);
-  if (stream->release != nullptr) {
-    ArrowArrayStreamRelease(stream);
+///
+/// Releases the GIL for its lifetime if the calling thread holds it. Stream
+/// callbacks may be invoked from Python with the GIL held or by native
+/// consumers which have already released it.
+///
+class ReleaseGILIfHeld {
+public:
+  ReleaseGILIfHeld()
+      : state_{PyGILState_Check() != 0 ? PyEval_SaveThread() : nullptr} {}
+  ReleaseGILIfHeld(const ReleaseGILIfHeld &) = delete;
+  ReleaseGILIfHeld &operator=(const ReleaseGILIfHeld &) = delete;
+  ReleaseGILIfHeld(ReleaseGILIfHeld &&) = delete;
+  ReleaseGILIfHeld &operator=(ReleaseGILIfHeld &&) = delete;
+
+  ~ReleaseGILIfHeld() {
+    if (state_ != nullptr) {
+      PyEval_RestoreThread(state_);
+    }
   }
 
-  delete stream;
-}
-
-static const auto GetSchema = [](struct ArrowArrayStream *stream,
-                                 struct ArrowSchema *out) noexcept {
-  auto private_data =
-      static_cast<HyperResultIteratorPrivate *>(stream->private_data);
+private:
+  PyThreadState *state_;
+};
 
-  const auto resultSchema = private_data->result_->getSchema();
+///
+/// Builds the struct schema of a result, suffixing repeated column names
+/// with a counter so that every child is uniquely named
+///
+static auto MakeResultSchema(const hyper_table_definition_t *definition)
+    -> nanoarrow::UniqueSchema {
+  const auto column_count = hyper_table_definition_column_count(definition);
 
   nanoarrow::UniqueSchema schema{};
   ArrowSchemaInit(schema.get());
-
-  if (ArrowSchemaSetTypeStruct(
-          schema.get(), static_cast<int64_t>(resultSchema.getColumnCount()))) {
-    ArrowErrorSetString(&private_data->error_,
-                        "ArrowSchemaSetTypeStruct failed!");
-    return EINVAL;
+  if (ArrowSchemaSetTypeStruct(schema.get(),
+                               static_cast<int64_t>(column_count))) {
+    throw std::runtime_error("ArrowSchemaSetTypeStruct failed!");
   }
 
-  const auto column_count = resultSchema.getColumnCount();
   std::unordered_map<std::string, size_t> name_counter;
   const std::span children{schema->children,
                            static_cast<size_t>(schema->n_children)};
-
   for (size_t i = 0; i < column_count; i++) {
-    const auto column = resultSchema.getColumn(i);
-    auto name = column.getName().getUnescaped();
+    const auto column = static_cast<hyper_field_index_t>(i);
+    std::string name{hyper_table_definition_column_name(definition, column)};
     const auto &[elem, did_insert] = name_counter.emplace(name, 0);
     if (!did_insert) {
       name = name + "_" + std::to_string(elem->second);
@@ -498,125 +589,302 @@ static const auto GetSchema = [](struct ArrowArrayStream *stream,
     elem->second += 1;
 
     if (ArrowSchemaSetName(children[i], name.c_str())) {
-      ArrowErrorSetString(&private_data->error_, "ArrowSchemaSetName failed!");
-      return EINVAL;
+      throw std::runtime_error("ArrowSchemaSetName failed!");
     }
 
-    SetSchemaTypeFromHyperType(children[i], column.getType());
+    const hyperapi::SqlType sqltype{
+        static_cast<hyperapi::TypeTag>(
+            hyper_table_definition_column_type_tag(definition, column)),
+        hyper_table_definition_column_type_oid(definition, column),
+        hyper_table_definition_column_type_modifier(definition, column)};
+    SetSchemaTypeFromHyperType(children[i], sqltype);
   }
 
-  ArrowSchemaMove(schema.get(), out);
-  return 0;
+  return schema;
+}
+
+static auto MakeColumnDecoders(const struct ArrowSchema *schema)
+    -> std::vector<ColumnDecoderVariant> {
+  const std::span children{schema->children,
+                           static_cast<size_t>(schema->n_children)};
+  std::vector<ColumnDecoderVariant> decoders;
+  decoders.reserve(children.size());
+  for (const auto child : children) {
+    struct ArrowSchemaView schema_view {};
+    if (ArrowSchemaViewInit(&schema_view, child, nullptr)) {
+      throw std::runtime_error("ArrowSchemaViewInit failed!");
+    }
+
+    decoders.emplace_back(MakeColumnDecoder(&schema_view));
+  }
+
+  return decoders;
+}
+
+///
+/// Decodes upcoming chunks of a result on a background thread into a queue
+/// of at most queue_depth batches, so that fetching from Hyper overlaps with
+/// whatever the consumer does with the previous batch
+///
+class ResultPrefetcher {
+public:
+  using ReadChunk = std::function<std::optional<nanoarrow::UniqueArray>()>;
+
+  ResultPrefetcher(ReadChunk read_chunk, size_t queue_depth)
+      : read_chunk_{std::move(read_chunk)}, queue_depth_{queue_depth},
+        worker_{[this] { Run(); }} {}
+
+  ResultPrefetcher(const ResultPrefetcher &) = delete;
+  auto operator=(const ResultPrefetcher &) -> ResultPrefetcher & = delete;
+  ResultPrefetcher(ResultPrefetcher &&) = delete;
+  auto operator=(ResultPrefetcher &&) -> ResultPrefetcher & = delete;
+
+  ~ResultPrefetcher() {
+    {
+      const std::lock_guard lock{mutex_};
+      stopped_ = true;
+    }
+    space_available_.notify_one();
+    worker_.join();
+  }
+
+  ///
+  /// Returns the next decoded chunk, or std::nullopt once the result is
+  /// exhausted. Errors hit by the worker are rethrown here, after any chunks
+  /// decoded before the error have been consumed.
+  ///
+  auto Next() -> std::optional<nanoarrow::UniqueArray> {
+    std::unique_lock lock{mutex_};
+    chunk_available_.wait(lock,
+                          [this] { return !queue_.empty() || finished_; });
+    if (!queue_.empty()) {
+      auto chunk = std::move(queue_.front());
+      queue_.pop_front();
+      lock.unlock();
+      space_available_.notify_one();
+      return chunk;
+    }
+
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+    return std::nullopt;
+  }
+
+private:
+  auto Run() -> void {
+    try {
+      while (true) {
+        {
+          std::unique_lock lock{mutex_};
+          space_available_.wait(lock, [this] {
+            return stopped_ || queue_.size() < queue_depth_;
+          });
+          if (stopped_) {
+            break;
+          }
+        }
+
+        auto chunk = read_chunk_();
+        if (!chunk) {
+          break;
+        }
+
+        {
+          const std::lock_guard lock{mutex_};
+          queue_.emplace_back(std::move(*chunk));
+        }
+        chunk_available_.notify_one();
+      }
+    } catch (...) {
+      const std::lock_guard lock{mutex_};
+      error_ = std::current_exception();
+    }
+
+    {
+      const std::lock_guard lock{mutex_};
+      finished_ = true;
+    }
+    chunk_available_.notify_one();
+  }
+
+  ReadChunk read_chunk_;
+  size_t queue_depth_;
+
+  std::mutex mutex_;
+  std::condition_variable chunk_available_;
+  std::condition_variable space_available_;
+  std::deque<nanoarrow::UniqueArray> queue_;
+  bool finished_{};
+  bool stopped_{};
+  std::exception_ptr error_;
+  // started last, once every member it uses has been initialized
+  std::thread worker_;
 };
 
-static const auto GetNext = [](struct ArrowArrayStream *stream,
-                               struct ArrowArray *out) noexcept {
+struct HyperResultIteratorPrivate {
+  HyperResultIteratorPrivate(std::shared_ptr<HyperSession> session,
+                             const std::string &path)
+      : session_(std::move(session)), connection_(session_, path) {}
+
+  // the result must be closed before its connection goes back to the session
+  const std::shared_ptr<HyperSession> session_;
+  PooledConnection connection_;
+  std::unique_ptr<Rowset> rowset_;
+  // compiled once per result and reused for every chunk
+  nanoarrow::UniqueSchema schema_;
+  std::vector<ColumnDecoderVariant> decoders_;
+  struct ArrowError error_ {};
+  // declared last so that its worker stops before the result is closed
+  std::unique_ptr<ResultPrefetcher> prefetcher_;
+};
+
+static auto ReleaseArrowStream(void *ptr) noexcept -> void {
+  auto stream = static_cast<gsl::owner<ArrowArrayStream *>>(ptr);
+  if (stream->release != nullptr) {
+    ArrowArrayStreamRelease(stream);
+  }
+
+  delete stream;
+}
+
+static const auto GetSchema = [](struct ArrowArrayStream *stream,
+                                 struct ArrowSchema *out) noexcept {
   auto private_data =
       static_cast<HyperResultIteratorPrivate *>(stream->private_data);
 
-  auto end = hyperapi::ChunkedResultIterator{*private_data->result_,
-                                             hyperapi::IteratorEndTag{}};
-  if (private_data->iter_ == end) {
-    return 0;
+  if (ArrowSchemaDeepCopy(private_data->schema_.get(), out)) {
+    ArrowErrorSetString(&private_data->error_, "ArrowSchemaDeepCopy failed!");
+    return ENOMEM;
   }
 
-  nanoarrow::UniqueSchema schema{};
-  if (int errcode = GetSchema(stream, schema.get())) {
-    return errcode;
-  }
+  return 0;
+};
 
-  const auto column_count = static_cast<size_t>(schema->n_children);
+///
+/// Decodes a chunk into a struct array, one column at a time so that each
+/// column's buffers are written front to back with a single type dispatch
+///
+static auto DecodeChunk(HyperResultIteratorPrivate &private_data,
+                        const RawChunk &chunk) -> nanoarrow::UniqueArray {
   nanoarrow::UniqueArray array{};
-  if (ArrowArrayInitFromSchema(array.get(), schema.get(), nullptr)) {
-    ArrowErrorSetString(&private_data->error_,
-                        "ArrowArrayInitFromSchema failed!");
-    return EINVAL;
+  if (ArrowArrayInitFromSchema(array.get(), private_data.schema_.get(),
+                               nullptr)) {
+    throw std::runtime_error("ArrowArrayInitFromSchema failed!");
   }
 
-  // TODO: we might want to move the vector of ReadHelpers to the private_data
-  // rather than doing on each loop iteration here
-  std::vector<std::unique_ptr<ReadHelper>> read_helpers{column_count};
-  const std::span schema_children{schema->children,
-                                  static_cast<size_t>(schema->n_children)};
+  auto &decoders = private_data.decoders_;
   const std::span array_children{array->children,
                                  static_cast<size_t>(array->n_children)};
-  for (size_t i = 0; i < column_count; i++) {
-    struct ArrowSchemaView schema_view {};
-    if (ArrowSchemaViewInit(&schema_view, schema_children[i], nullptr)) {
-      ArrowErrorSetString(&private_data->error_, "ArrowSchemaViewInit failed!");
-      return EINVAL;
-    }
-
-    auto read_helper = MakeReadHelper(&schema_view, array_children[i]);
-    read_helpers[i] = std::move(read_helper);
+  const auto nrows = chunk.GetRowCount();
+  for (size_t i = 0; i < decoders.size(); i++) {
+    ColumnBuilder builder{array_children[i], nrows};
+    std::visit(
+        [&](auto &decoder) {
+          decoder.Decode(chunk, static_cast<hyper_field_index_t>(i), builder);
+        },
+        decoders[i]);
+    builder.Finish();
   }
+  array->length = static_cast<int64_t>(nrows);
 
-  if (ArrowArrayStartAppending(array.get())) {
-    ArrowErrorSetString(&private_data->error_,
-                        "ArrowArrayStartAppending failed!");
-    return EINVAL;
+  if (ArrowArrayFinishBuildingDefault(array.get(), nullptr)) {
+    throw std::runtime_error("ArrowArrayFinishBuildingDefault failed!");
   }
-  for (const auto &row : *private_data->iter_) {
-    size_t column_idx = 0;
-    for (const auto &value : row) {
-      const auto &read_helper = read_helpers[column_idx];
-      read_helper->Read(value);
-      column_idx++;
-    }
-    if (ArrowArrayFinishElement(array.get())) {
-      ArrowErrorSetString(&private_data->error_,
-                          "ArrowArrayFinishElement failed!");
-      return EINVAL;
+
+  return array;
+}
+
+///
+/// Fetches and decodes the next non-empty chunk of the result, or returns
+/// std::nullopt once it is exhausted
+///
+static auto DecodeNextChunk(HyperResultIteratorPrivate &private_data)
+    -> std::optional<nanoarrow::UniqueArray> {
+  while (auto *handle = private_data.rowset_->FetchNextChunk()) {
+    const RawChunk chunk{handle};
+    if (chunk.GetRowCount() != 0) {
+      return DecodeChunk(private_data, chunk);
     }
   }
-  ++(private_data->iter_);
 
-  if (ArrowArrayFinishBuildingDefault(array.get(), nullptr)) {
-    ArrowErrorSetString(&private_data->error_,
-                        "ArrowArrayFinishBuildingDefault failed!");
+  return std::nullopt;
+}
+
+static const auto GetNext = [](struct ArrowArrayStream *stream,
+                               struct ArrowArray *out) noexcept {
+  // fetching and decoding a chunk never calls back into Python
+  const ReleaseGILIfHeld release{};
+  auto private_data =
+      static_cast<HyperResultIteratorPrivate *>(stream->private_data);
+
+  try {
+    auto chunk = private_data->prefetcher_
+                     ? private_data->prefetcher_->Next()
+                     : DecodeNextChunk(*private_data);
+    if (!chunk) {
+      out->release = nullptr;
+      return 0;
+    }
+
+    ArrowArrayMove(chunk->get(), out);
+  } catch (const std::exception &e) {
+    ArrowErrorSetString(&private_data->error_, e.what());
     return EINVAL;
   }
 
-  ArrowArrayMove(array.get(), out);
-
   return 0;
 };
 
-auto read_from_hyper_query(
-    const std::string &path, const std::string &query,
-    std::unordered_map<std::string, std::string> &&process_params,
-    size_t chunk_size) -> nb::capsule {
-
-  if (!process_params.count("log_config")) {
-    process_params["log_config"] = "";
-  } else {
-    process_params.erase("log_config");
-  }
-  if (!process_params.count("default_database_version"))
-    process_params["default_database_version"] = "2";
-
-  hyperapi::HyperProcess hyper{hyperapi::Telemetry::DoNotSendUsageDataToTableau,
-                               "", std::move(process_params)};
-  hyperapi::Connection connection(hyper.getEndpoint(), path);
+static auto ExecuteHyperQuery(std::shared_ptr<HyperSession> session,
+                              const std::string &path,
+                              const std::string &query, size_t chunk_size,
+                              size_t queue_depth)
+    -> std::unique_ptr<HyperResultIteratorPrivate> {
+  auto private_data =
+      std::make_unique<HyperResultIteratorPrivate>(std::move(session), path);
 
+  // pooled connections keep the settings of whichever query last used them
+  auto &connection = private_data->connection_.Get();
+  hyper_set_chunked_mode(hyperapi::internal::getHandle(connection),
+                         chunk_size != 0);
   if (chunk_size) {
-    hyper_set_chunked_mode(hyperapi::internal::getHandle(connection), true);
     hyper_set_chunk_size(hyperapi::internal::getHandle(connection), chunk_size);
   }
 
-  auto hyperResult =
-      std::make_unique<hyperapi::Result>(connection.executeQuery(query));
+  private_data->rowset_ = std::make_unique<Rowset>(connection, query);
+  private_data->schema_ =
+      MakeResultSchema(private_data->rowset_->GetTableDefinition());
+  private_data->decoders_ = MakeColumnDecoders(private_data->schema_.get());
+
+  if (queue_depth > 0) {
+    private_data->prefetcher_ = std::make_unique<ResultPrefetcher>(
+        [state = private_data.get()] { return DecodeNextChunk(*state); },
+        queue_depth);
+  }
 
-  hyperapi::ChunkedResultIterator iter{*hyperResult,
-                                       hyperapi::IteratorBeginTag{}};
+  return private_data;
+}
 
-  auto private_data = gsl::owner<HyperResultIteratorPrivate *>(
-      new HyperResultIteratorPrivate{std::move(hyper), std::move(connection),
-                                     std::move(hyperResult), std::move(iter)});
+auto read_from_hyper_query(
+    const std::string &path, const std::string &query,
+    std::unordered_map<std::string, std::string> &&process_params,
+    size_t chunk_size, size_t queue_depth, const Session *session)
+    -> nb::capsule {
+  auto session_state = GetSessionState(session);
+  std::unique_ptr<HyperResultIteratorPrivate> private_data;
+  {
+    // starting the process and running the query do not touch Python
+    const nb::gil_scoped_release release{};
+    auto hyper =
+        GetOrCreateSession(std::move(session_state), std::move(process_params));
+    private_data = ExecuteHyperQuery(std::move(hyper), path, query,
+                                     chunk_size, queue_depth);
+  }
 
   auto stream =
       gsl::owner<struct ArrowArrayStream *>(new struct ArrowArrayStream);
-  stream->private_data = private_data;
+  stream->private_data = private_data.release();
   stream->get_next = GetNext;
   stream->get_schema = GetSchema;
   stream->get_last_error = [](struct ArrowArrayStream *stream) {
@@ -628,6 +896,9 @@ auto read_from_hyper_query(
   stream->release = [](struct ArrowArrayStream *stream) {
     auto private_data = static_cast<gsl::owner<HyperResultIteratorPrivate *>>(
         stream->private_data);
+    // closing the result (and the process, if this stream was its last
+    // user) waits on Hyper
+    const ReleaseGILIfHeld release{};
     delete private_data;
     stream->release = nullptr;
   };
@@ -4,7 +4,10 @@
 #include <nanobind/stl/string.h>
 #include <nanobind/stl/unordered_map.h>
 
+#include "session.hpp"
+
 auto read_from_hyper_query(
     const std::string &path, const std::string &query,
     std::unordered_map<std::string, std::string> &&process_params,
-    size_t chunk_size) -> nanobind::capsule;
+    size_t chunk_size, size_t queue_depth, const Session *session)
+    -> nanobind::capsule;
@@ -0,0 +1,110 @@
+#include "session.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+static auto
+ApplyDefaultProcessParams(std::unordered_map<std::string, std::string> &&params)
+    -> std::unordered_map<std::string, std::string> {
+  if (!params.count("log_config")) {
+    params["log_config"] = "";
+  } else {
+    params.erase("log_config");
+  }
+  if (!params.count("default_database_version"))
+    params["default_database_version"] = "2";
+
+  return std::move(params);
+}
+
+HyperSession::HyperSession(
+    std::unordered_map<std::string, std::string> &&process_params)
+    : process_{hyperapi::Telemetry::DoNotSendUsageDataToTableau, "",
+               ApplyDefaultProcessParams(std::move(process_params))} {}
+
+auto HyperSession::GetEndpoint() const -> hyperapi::Endpoint {
+  return process_.getEndpoint();
+}
+
+auto HyperSession::AcquireConnection(const std::string &path)
+    -> hyperapi::Connection {
+  {
+    const std::lock_guard lock{mutex_};
+    const auto it = idle_.find(path);
+    if (it != idle_.end() && !it->second.empty()) {
+      auto connection = std::move(it->second.back());
+      it->second.pop_back();
+      return connection;
+    }
+  }
+
+  return hyperapi::Connection{process_.getEndpoint(), path};
+}
+
+auto HyperSession::ReleaseConnection(const std::string &path,
+                                     hyperapi::Connection &&connection)
+    -> void {
+  const std::lock_guard lock{mutex_};
+  idle_[path].emplace_back(std::move(connection));
+}
+
+auto HyperSession::DropConnections(const std::string &path) -> void {
+  std::vector<hyperapi::Connection> dropped;
+  {
+    const std::lock_guard lock{mutex_};
+    const auto it = idle_.find(path);
+    if (it != idle_.end()) {
+      dropped = std::move(it->second);
+      idle_.erase(it);
+    }
+  }
+  // connections close as dropped goes out of scope, outside of the lock
+}
+
+PooledConnection::PooledConnection(std::shared_ptr<HyperSession> session,
+                                   std::string path)
+    : session_{std::move(session)}, path_{std::move(path)},
+      connection_{session_->AcquireConnection(path_)} {}
+
+PooledConnection::~PooledConnection() {
+  try {
+    session_->ReleaseConnection(path_, std::move(connection_));
+  } catch (...) {
+    // the connection is simply closed instead
+  }
+}
+
+Session::Session(std::unordered_map<std::string, std::string> &&process_params)
+    : state_{std::make_shared<HyperSession>(std::move(process_params))} {}
+
+auto Session::Get() const -> std::shared_ptr<HyperSession> {
+  if (!state_) {
+    throw std::invalid_argument("Session is closed");
+  }
+  return state_;
+}
+
+auto Session::Release() -> std::shared_ptr<HyperSession> {
+  return std::move(state_);
+}
+
+auto Session::DropConnections(const std::string &path) -> void {
+  if (state_) {
+    state_->DropConnections(path);
+  }
+}
+
+auto GetSessionState(const Session *session)
+    -> std::shared_ptr<HyperSession> {
+  return session != nullptr ? session->Get() : nullptr;
+}
+
+auto GetOrCreateSession(
+    std::shared_ptr<HyperSession> state,
+    std::unordered_map<std::string, std::string> &&process_params)
+    -> std::shared_ptr<HyperSession> {
+  if (state) {
+    return state;
+  }
+  return std::make_shared<HyperSession>(std::move(process_params));
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <hyperapi/hyperapi.hpp>
+
+///
+/// A running Hyper process, along with idle connections to each database it
+/// has read from so that later reads can skip connection setup
+///
+class HyperSession {
+public:
+  explicit HyperSession(
+      std::unordered_map<std::string, std::string> &&process_params);
+
+  auto GetEndpoint() const -> hyperapi::Endpoint;
+
+  ///
+  /// Returns an idle connection to path, or opens a new one
+  ///
+  auto AcquireConnection(const std::string &path) -> hyperapi::Connection;
+
+  ///
+  /// Hands a connection obtained from AcquireConnection back for reuse
+  ///
+  auto ReleaseConnection(const std::string &path,
+                         hyperapi::Connection &&connection) -> void;
+
+  ///
+  /// Closes the idle connections to path, which must happen before the file
+  /// is replaced or recreated
+  ///
+  auto DropConnections(const std::string &path) -> void;
+
+private:
+  hyperapi::HyperProcess process_;
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::vector<hyperapi::Connection>> idle_;
+};
+
+///
+/// A connection borrowed from a HyperSession for the lifetime of this object
+///
+class PooledConnection {
+public:
+  PooledConnection(std::shared_ptr<HyperSession> session, std::string path);
+  PooledConnection(const PooledConnection &) = delete;
+  auto operator=(const PooledConnection &) -> PooledConnection & = delete;
+  PooledConnection(PooledConnection &&) = delete;
+  auto operator=(PooledConnection &&) -> PooledConnection & = delete;
+  ~PooledConnection();
+
+  auto Get() -> hyperapi::Connection & { return connection_; }
+
+private:
+  std::shared_ptr<HyperSession> session_;
+  std::string path_;
+  hyperapi::Connection connection_;
+};
+
+///
+/// The Session exposed to Python. Its methods are called with the GIL held.
+/// Closing it only drops the Python side's reference, so streams which are
+/// still being read keep the process alive.
+///
+class Session {
+public:
+  explicit Session(
+      std::unordered_map<std::string, std::string> &&process_params);
+
+  auto Get() const -> std::shared_ptr<HyperSession>;
+
+  ///
+  /// Detaches the state from this session, which is closed afterwards
+  ///
+  auto Release() -> std::shared_ptr<HyperSession>;
+
+  auto DropConnections(const std::string &path) -> void;
+
+private:
+  std::shared_ptr<HyperSession> state_;
+};
+
+///
+/// The state of session, or nullptr if no session was provided. Must be
+/// called with the GIL held.
+///
+auto GetSessionState(const Session *session) -> std::shared_ptr<HyperSession>;
+
+///
+/// Returns state, or starts a new process used only by the calling function
+/// when state is empty
+///
+auto GetOrCreateSession(
+    std::shared_ptr<HyperSession> state,
+    std::unordered_map<std::string, std::string> &&process_params)
+    -> std::shared_ptr<HyperSession>;
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include <nanoarrow/nanoarrow.h>
+
+// Batch conversions between Arrow temporal buffers and Hyper's raw
+// representations. Hyper stores dates as Julian day numbers, and times and
+// timestamps as unsigned microseconds since midnight and since the Julian
+// epoch respectively.
+//
+// Each kernel converts a whole buffer in one branch-free loop, folding the
+// range check into an accumulated flag so the compiler can vectorize it. The
+// arithmetic runs on unsigned values, so out-of-range inputs (including the
+// arbitrary contents of null slots) wrap rather than overflow; callers decide
+// whether a flagged range failure touched a valid slot.
+namespace temporal {
+
+inline constexpr int64_t MicrosecondsPerSecond = 1'000'000;
+inline constexpr int64_t MicrosecondsPerMillisecond = 1'000;
+inline constexpr int64_t NanosecondsPerMicrosecond = 1'000;
+inline constexpr int64_t MicrosecondsPerDay = 86'400 * MicrosecondsPerSecond;
+
+inline constexpr int32_t UnixEpochJulianDay = 2'440'588;
+inline constexpr int64_t UnixEpochJulianMicroseconds =
+    UnixEpochJulianDay * MicrosecondsPerDay;
+
+///
+/// Inclusive bounds on source values, expressed in the source unit
+///
+struct Bounds {
+  int64_t lower;
+  int64_t upper;
+};
+
+template <enum ArrowTimeUnit TU> constexpr auto MicrosecondsMultiplier() {
+  if constexpr (TU == NANOARROW_TIME_UNIT_SECOND) {
+    return MicrosecondsPerSecond;
+  } else if constexpr (TU == NANOARROW_TIME_UNIT_MILLI) {
+    return MicrosecondsPerMillisecond;
+  } else {
+    return int64_t{1};
+  }
+}
+
+///
+/// Source values v for which v (scaled to microseconds) + offset lands in
+/// [0, limit]
+///
+template <enum ArrowTimeUnit TU>
+constexpr auto MicrosecondBounds(int64_t offset, int64_t limit) -> Bounds {
+  if constexpr (TU == NANOARROW_TIME_UNIT_NANO) {
+    constexpr auto min_value = std::numeric_limits<int64_t>::min();
+    constexpr auto max_value = std::numeric_limits<int64_t>::max();
+    const auto lower_usec = -offset;
+    const auto upper_usec = limit - offset;
+    return {lower_usec < min_value / NanosecondsPerMicrosecond
+                ? min_value
+                : lower_usec * NanosecondsPerMicrosecond,
+            upper_usec > max_value / NanosecondsPerMicrosecond
+                ? max_value
+                : upper_usec * NanosecondsPerMicrosecond +
+                      (NanosecondsPerMicrosecond - 1)};
+  } else {
+    constexpr auto multiplier = MicrosecondsMultiplier<TU>();
+    // round the lower bound towards positive infinity
+    const auto lower = -offset / multiplier;
+    return {lower * multiplier < -offset ? lower + 1 : lower,
+            (limit - offset) / multiplier};
+  }
+}
+
+///
+/// Converts values in unit TU to microseconds plus offset. Returns true if
+/// any input fell outside of bounds.
+///
+template <enum ArrowTimeUnit TU>
+auto ToMicroseconds(std::span<const int64_t> values, int64_t offset,
+                    Bounds bounds, std::span<int64_t> out) -> bool {
+  bool out_of_range = false;
+  for (size_t i = 0; i < values.size(); i++) {
+    const auto value = values[i];
+    out_of_range |= (value < bounds.lower) | (value > bounds.upper);
+
+    uint64_t usec{};
+    if constexpr (TU == NANOARROW_TIME_UNIT_NANO) {
+      usec = static_cast<uint64_t>(value / NanosecondsPerMicrosecond);
+    } else {
+      usec = static_cast<uint64_t>(value) *
+             static_cast<uint64_t>(MicrosecondsMultiplier<TU>());
+    }
+    out[i] = static_cast<int64_t>(usec + static_cast<uint64_t>(offset));
+  }
+
+  return out_of_range;
+}
+
+///
+/// Converts days since the Unix epoch into Julian day numbers. Returns true
+/// if any input precedes the Julian epoch.
+///
+inline auto ToJulianDays(std::span<const int32_t> values,
+                         std::span<uint32_t> out) -> bool {
+  bool out_of_range = false;
+  for (size_t i = 0; i < values.size(); i++) {
+    const auto value = values[i];
+    out_of_range |= value < -UnixEpochJulianDay;
+    out[i] = static_cast<uint32_t>(value) +
+             static_cast<uint32_t>(UnixEpochJulianDay);
+  }
+
+  return out_of_range;
+}
+
+///
+/// Converts Julian day numbers into days since the Unix epoch in place
+///
+inline auto FromJulianDays(std::span<int32_t> values) -> void {
+  for (auto &value : values) {
+    value = static_cast<int32_t>(static_cast<uint32_t>(value) -
+                                 static_cast<uint32_t>(UnixEpochJulianDay));
+  }
+}
+
+///
+/// Converts microseconds since the Julian epoch into microseconds since the
+/// Unix epoch in place
+///
+inline auto FromJulianMicroseconds(std::span<int64_t> values) -> void {
+  for (auto &value : values) {
+    value = static_cast<int64_t>(
+        static_cast<uint64_t>(value) -
+        static_cast<uint64_t>(UnixEpochJulianMicroseconds));
+  }
+}
+
+} // namespace temporal
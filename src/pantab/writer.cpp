@@ -1,14 +1,35 @@
 #include "writer.hpp"
+#include "decimal_codec.hpp"
 #include "numeric_gen.hpp"
+#include "temporal.hpp"
 
 #include <hyperapi/hyperapi.hpp>
 #include <nanoarrow/nanoarrow.hpp>
 
-#include <chrono>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
 #include <set>
 #include <span>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <variant>
+#include <vector>
 
 static auto GetHyperTypeFromArrowSchema(struct ArrowSchema *schema,
                                         ArrowError *error)
@@ -70,16 +91,23 @@ static auto GetHyperTypeFromArrowSchema(struct ArrowSchema *schema,
     NANOARROW_THROW_NOT_OK(
         ArrowSchemaViewInit(&value_view, schema->dictionary, &error));
 
-    // only support dictionary-encoded string values for now
     switch (value_view.type) {
     case NANOARROW_TYPE_STRING:
     case NANOARROW_TYPE_LARGE_STRING:
     case NANOARROW_TYPE_STRING_VIEW:
-      return hyperapi::SqlType::text();
+    case NANOARROW_TYPE_BINARY:
+    case NANOARROW_TYPE_LARGE_BINARY:
+    case NANOARROW_TYPE_BINARY_VIEW:
+    case NANOARROW_TYPE_INT8:
+    case NANOARROW_TYPE_INT16:
+    case NANOARROW_TYPE_INT32:
+    case NANOARROW_TYPE_INT64:
+    case NANOARROW_TYPE_DATE32:
+      return GetHyperTypeFromArrowSchema(schema->dictionary, &error);
     default:
       throw std::invalid_argument(
-          std::string(
-              "Can only encode dictionaries with binary value types, got:") +
+          std::string("Can only encode dictionaries with string, binary, "
+                      "integer or date value types, got:") +
           ArrowTypeString(value_view.type));
     }
   }
@@ -89,585 +117,1280 @@ static auto GetHyperTypeFromArrowSchema(struct ArrowSchema *schema,
   }
 }
 
-class InsertHelper {
+///
+/// The size of the buffers a view references, including those of its children
+/// and dictionary
+///
+static auto ArrayViewBytes(const struct ArrowArrayView *view) -> int64_t {
+  int64_t nbytes = 0;
+  for (const auto &buffer_view : std::span{view->buffer_views}) {
+    nbytes += buffer_view.size_bytes;
+  }
+  for (const auto size : std::span{view->variadic_buffer_sizes,
+                                   static_cast<size_t>(
+                                       view->n_variadic_buffers)}) {
+    nbytes += size;
+  }
+  for (const auto *child :
+       std::span{view->children, static_cast<size_t>(view->n_children)}) {
+    nbytes += ArrayViewBytes(child);
+  }
+  if (view->dictionary != nullptr) {
+    nbytes += ArrayViewBytes(view->dictionary);
+  }
+
+  return nbytes;
+}
+
+///
+/// Statistics of a column over a batch of rows. Minimum and maximum values
+/// are rendered as text that Hyper can cast back to the column type.
+///
+struct ColumnStatistics {
+  int64_t null_count{};
+  std::optional<int64_t> distinct_count;
+  std::optional<std::string> min_value;
+  std::optional<std::string> max_value;
+};
+
+struct BatchStatistics {
+  int64_t row_count{};
+  std::vector<ColumnStatistics> columns;
+};
+
+///
+/// The smallest and largest of the values a kernel has seen. Floating point
+/// NaN sorts after every other value, as it does in Hyper.
+///
+template <typename T> class ValueRange {
 public:
-  InsertHelper(hyperapi::Inserter &inserter, const struct ArrowArray *chunk,
-               const struct ArrowSchema *schema, struct ArrowError *error,
-               int64_t column_position)
-      : inserter_(inserter), chunk_(chunk), error_(error),
-        column_position_(column_position) {
+  auto Update(const T &value) -> void {
+    if (!min_ || Less(value, *min_)) {
+      min_ = value;
+    }
+    if (!max_ || Less(*max_, value)) {
+      max_ = value;
+    }
+  }
+
+  ///
+  /// Folds in the range of another, converting its values to T
+  ///
+  template <typename U> auto Merge(const ValueRange<U> &other) -> void {
+    if (other.Min()) {
+      Update(T{*other.Min()});
+      Update(T{*other.Max()});
+    }
+  }
+
+  auto Min() const -> const std::optional<T> & { return min_; }
+  auto Max() const -> const std::optional<T> & { return max_; }
+
+  auto Reset() -> void {
+    min_.reset();
+    max_.reset();
+  }
+
+  ///
+  /// Renders the range into stats and starts over
+  ///
+  template <typename F> auto Take(ColumnStatistics &stats, F format) -> void {
+    if (min_) {
+      stats.min_value = format(*min_);
+      stats.max_value = format(*max_);
+    }
+    Reset();
+  }
+
+private:
+  static auto Less(const T &lhs, const T &rhs) -> bool {
+    if constexpr (std::is_floating_point_v<T>) {
+      return !std::isnan(lhs) && (std::isnan(rhs) || lhs < rhs);
+    } else if constexpr (std::is_same_v<T, decimal_codec::Decimal128>) {
+      return decimal_codec::Less(lhs, rhs);
+    } else {
+      return lhs < rhs;
+    }
+  }
+
+  std::optional<T> min_;
+  std::optional<T> max_;
+};
+
+template <typename T> static auto FormatNumber(T value) -> std::string {
+  if constexpr (std::is_floating_point_v<T>) {
+    if (std::isnan(value)) {
+      return "NaN";
+    }
+    if (std::isinf(value)) {
+      return value < 0 ? "-Infinity" : "Infinity";
+    }
+    // the shortest text that reads back as the same value
+    static constexpr size_t MaxFloatChars = 32;
+    std::array<char, MaxFloatChars> buffer{};
+    const auto result =
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    return {buffer.data(), result.ptr};
+  } else {
+    return std::to_string(value);
+  }
+}
+
+static auto PadNumber(int64_t value, size_t width) -> std::string {
+  auto text = std::to_string(value);
+  if (text.size() < width) {
+    text.insert(0, width - text.size(), '0');
+  }
+  return text;
+}
+
+///
+/// Renders a Julian day number as an ISO date. Hyper dates reach back into
+/// the years before Christ, which are suffixed with BC.
+///
+static auto FormatDate(hyper_date_t raw_date, std::string_view suffix = {})
+    -> std::string {
+  static constexpr size_t YearDigits = 4;
+  static constexpr size_t MonthDayDigits = 2;
+  const hyperapi::Date date{raw_date, {}};
+  const auto year = date.getYear();
+  return PadNumber(year > 0 ? year : 1 - year, YearDigits) + "-" +
+         PadNumber(date.getMonth(), MonthDayDigits) + "-" +
+         PadNumber(date.getDay(), MonthDayDigits) + std::string{suffix} +
+         (year > 0 ? "" : " BC");
+}
+
+///
+/// Renders microseconds since midnight as a time of day
+///
+static auto FormatTime(int64_t microseconds) -> std::string {
+  static constexpr int64_t SecondsPerMinute = 60;
+  static constexpr int64_t MinutesPerHour = 60;
+  static constexpr size_t ClockDigits = 2;
+  static constexpr size_t FractionDigits = 6;
+  const auto seconds = microseconds / temporal::MicrosecondsPerSecond;
+  return PadNumber(seconds / SecondsPerMinute / MinutesPerHour, ClockDigits) +
+         ":" +
+         PadNumber(seconds / SecondsPerMinute % MinutesPerHour, ClockDigits) +
+         ":" + PadNumber(seconds % SecondsPerMinute, ClockDigits) + "." +
+         PadNumber(microseconds % temporal::MicrosecondsPerSecond,
+                   FractionDigits);
+}
+
+///
+/// Renders microseconds since the Julian epoch as a timestamp, in UTC for
+/// time zone aware columns
+///
+template <bool TZAware>
+static auto FormatTimestamp(int64_t microseconds) -> std::string {
+  const auto raw_date =
+      static_cast<hyper_date_t>(microseconds / temporal::MicrosecondsPerDay);
+  const auto time =
+      FormatTime(microseconds % temporal::MicrosecondsPerDay);
+  return FormatDate(raw_date, " " + time + (TZAware ? "+00" : ""));
+}
 
-    if (ArrowArrayViewInitFromSchema(array_view_.get(), schema, error_) != 0) {
-      throw std::runtime_error("Could not construct insert helper: " +
-                               std::string{&error_->message[0]});
+///
+/// Column kernels are compiled once per stream from the child schema and
+/// re-bound to every chunk. Each kernel is a concrete, non-virtual type that
+/// knows the physical layout of its Arrow column, so inserting a value is a
+/// typed buffer read followed by an Inserter::add call.
+///
+class ColumnKernel {
+public:
+  ColumnKernel(const struct ArrowSchema *schema, struct ArrowError *error)
+      : name_{schema->name != nullptr ? schema->name : ""} {
+    if (ArrowArrayViewInitFromSchema(array_view_.get(), schema, error) != 0) {
+      throw std::runtime_error("Could not construct column kernel: " +
+                               std::string{&error->message[0]});
     }
+  }
 
-    std::span children{chunk_->children,
-                       static_cast<size_t>(chunk_->n_children)};
-    if (ArrowArrayViewSetArray(array_view_.get(), children[column_position_],
-                               error_) != 0) {
+  auto Bind(const struct ArrowArray *array, struct ArrowError *error) -> void {
+    if (ArrowArrayViewSetArray(array_view_.get(), array, error) != 0) {
       throw std::runtime_error("Could not set array view: " +
-                               std::string{&error_->message[0]});
+                               std::string{&error->message[0]});
+    }
+
+    const auto array_view = GetArrayView();
+    null_count_ = array_view->null_count;
+    if (null_count_ < 0) {
+      null_count_ = ArrowArrayViewComputeNullCount(array_view);
     }
+
+    const auto validity_view = array_view->buffer_views[0];
+    validity_ = std::span{validity_view.data.as_uint8,
+                          static_cast<size_t>(validity_view.size_bytes)};
   }
 
-  InsertHelper(const InsertHelper &) = delete;
-  InsertHelper &operator=(const InsertHelper &) = delete;
-  InsertHelper(InsertHelper &&) = delete;
-  InsertHelper &operator=(InsertHelper &&) = delete;
+  auto HasNulls() const -> bool { return null_count_ != 0; }
 
-  virtual ~InsertHelper() = default;
-  virtual void InsertValueAtIndex(int64_t) {}
+  auto IsValid(int64_t idx) const -> bool {
+    return null_count_ == 0 || !ArrowArrayViewIsNull(GetArrayView(), idx);
+  }
 
-protected:
-  auto CheckNull(int64_t idx) const {
-    return ArrowArrayViewIsNull(array_view_.get(), idx);
+  auto BoundBytes() const -> int64_t { return ArrayViewBytes(GetArrayView()); }
+
+  ///
+  /// Adds the valid value at idx to the range of the column. Kernels of
+  /// types without an ordering keep no range, which the defaults below
+  /// implement.
+  ///
+  auto Observe([[maybe_unused]] int64_t idx) -> void {}
+
+  ///
+  /// Copies the values a range borrows from the bound chunk, which must
+  /// happen before the chunk is released
+  ///
+  auto SettleRange() -> void {}
+
+  ///
+  /// Moves the range observed since the last call into stats
+  ///
+  auto TakeRange([[maybe_unused]] ColumnStatistics &stats) -> void {}
+
+  ///
+  /// Returns the validity bits for rows [start, start + nbits) packed into a
+  /// single word, with bit i set when row start + i holds a value. Columns
+  /// without nulls or without any values never touch the bitmap.
+  ///
+  auto ValidityWord(int64_t start, int64_t nbits) const -> uint64_t {
+    const uint64_t mask =
+        nbits == BitsPerWord ? ~uint64_t{0} : (uint64_t{1} << nbits) - 1;
+    if (null_count_ == 0) {
+      return mask;
+    }
+    if (null_count_ == GetArrayView()->length) {
+      return 0;
+    }
+
+    const auto bit_offset = GetArrayView()->offset + start;
+    const auto first_byte = static_cast<size_t>(bit_offset / BitsPerByte);
+    const auto shift = static_cast<uint64_t>(bit_offset % BitsPerByte);
+    const auto bytes = validity_.subspan(first_byte);
+    const auto nbytes =
+        std::min(bytes.size(),
+                 static_cast<size_t>((static_cast<int64_t>(shift) + nbits +
+                                      BitsPerByte - 1) /
+                                     BitsPerByte));
+
+    // a word starting mid-byte spans up to nine bytes of the bitmap
+    uint64_t word{};
+    for (size_t i = 0; i < std::min(nbytes, sizeof(uint64_t)); i++) {
+      word |= static_cast<uint64_t>(bytes[i]) << (i * BitsPerByte);
+    }
+    word >>= shift;
+    if (nbytes > sizeof(uint64_t)) {
+      word |= static_cast<uint64_t>(bytes[sizeof(uint64_t)])
+              << (BitsPerWord - shift);
+    }
+
+    return word & mask;
   }
 
-  template <typename T> auto InsertNull() {
-    inserter_.add(hyperapi::optional<T>{});
+  static constexpr int64_t BitsPerWord = 64;
+
+protected:
+
+  auto GetArrayView() const -> const struct ArrowArrayView * {
+    return array_view_.get();
   }
 
-  auto GetArrayView() const { return array_view_.get(); }
+  auto GetName() const -> const std::string & { return name_; }
+
+  ///
+  /// Typed view over the values buffer, already adjusted for the array offset
+  ///
+  template <typename T> auto GetValues() const -> std::span<const T> {
+    const auto array_view = GetArrayView();
+    const auto buf_view = array_view->buffer_views[1];
+    const std::span raw_span{static_cast<const T *>(buf_view.data.data),
+                             static_cast<size_t>(buf_view.size_bytes) /
+                                 sizeof(T)};
+    return raw_span.subspan(static_cast<size_t>(array_view->offset));
+  }
 
-  template <typename T> auto InsertValue(T &&value) {
-    inserter_.add(std::forward<T>(value));
+  ///
+  /// Called after a batch conversion flagged a value outside of the range of
+  /// the Hyper type. Null slots may hold arbitrary values, so this only throws
+  /// if one of the offending values is valid.
+  ///
+  template <typename T, typename Pred>
+  auto CheckRange(std::span<const T> values, Pred in_range,
+                  std::string_view hyper_type) const -> void {
+    for (size_t i = 0; i < values.size(); i++) {
+      if (!in_range(values[i]) &&
+          (!HasNulls() ||
+           !ArrowArrayViewIsNull(GetArrayView(), static_cast<int64_t>(i)))) {
+        throw std::invalid_argument(
+            "Value " + std::to_string(values[i]) + " in column '" + name_ +
+            "' is out of range for Hyper type " + std::string{hyper_type});
+      }
+    }
   }
 
 private:
-  hyperapi::Inserter &inserter_;
-  const struct ArrowArray *chunk_;
-  struct ArrowError *error_;
-  const int64_t column_position_;
+  static constexpr int64_t BitsPerByte = 8;
+
+  std::string name_;
   nanoarrow::UniqueArrayView array_view_;
+  int64_t null_count_{};
+  std::span<const uint8_t> validity_;
 };
 
-template <typename T> class IntegralInsertHelper : public InsertHelper {
+template <typename ArrowT, typename HyperT>
+class PrimitiveKernel : public ColumnKernel {
 public:
-  using InsertHelper::InsertHelper;
+  using ColumnKernel::ColumnKernel;
 
-  void InsertValueAtIndex(int64_t idx) override {
-    if (CheckNull(idx)) {
-      InsertNull<T>();
-      return;
-    }
+  auto Bind(const struct ArrowArray *array, struct ArrowError *error) -> void {
+    ColumnKernel::Bind(array, error);
+    values_ = GetValues<ArrowT>();
+  }
 
-    const int64_t value = ArrowArrayViewGetIntUnsafe(GetArrayView(), idx);
-    InsertValue(static_cast<T>(value));
+  auto InsertNull(hyperapi::Inserter &inserter) const -> void {
+    inserter.add(hyperapi::optional<HyperT>{});
   }
-};
 
-class UInt32InsertHelper : public InsertHelper {
-public:
-  using InsertHelper::InsertHelper;
+  auto InsertValue(hyperapi::Inserter &inserter, int64_t idx) const -> void {
+    inserter.add(static_cast<HyperT>(values_[static_cast<size_t>(idx)]));
+  }
 
-  void InsertValueAtIndex(int64_t idx) override {
-    if (CheckNull(idx)) {
-      InsertNull<uint32_t>();
-      return;
-    }
+  auto Observe(int64_t idx) -> void {
+    range_.Update(static_cast<HyperT>(values_[static_cast<size_t>(idx)]));
+  }
 
-    const uint64_t value = ArrowArrayViewGetUIntUnsafe(GetArrayView(), idx);
-    InsertValue(static_cast<uint32_t>(value));
+  auto TakeRange(ColumnStatistics &stats) -> void {
+    range_.Take(stats, FormatNumber<HyperT>);
   }
+
+private:
+  std::span<const ArrowT> values_;
+  ValueRange<HyperT> range_;
 };
 
-template <typename T> class FloatingInsertHelper : public InsertHelper {
+class BooleanKernel : public ColumnKernel {
 public:
-  using InsertHelper::InsertHelper;
+  using ColumnKernel::ColumnKernel;
 
-  void InsertValueAtIndex(int64_t idx) override {
-    if (CheckNull(idx)) {
-      InsertNull<T>();
-      return;
-    }
+  auto InsertNull(hyperapi::Inserter &inserter) const -> void {
+    inserter.add(hyperapi::optional<bool>{});
+  }
 
-    const double value = ArrowArrayViewGetDoubleUnsafe(GetArrayView(), idx);
-    InsertValue(static_cast<T>(value));
+  auto InsertValue(hyperapi::Inserter &inserter, int64_t idx) const -> void {
+    const auto array_view = GetArrayView();
+    const bool value = ArrowBitGet(array_view->buffer_views[1].data.as_uint8,
+                                   array_view->offset + idx);
+    inserter.add(value);
   }
 };
 
-class BinaryInsertHelper : public InsertHelper {
+template <typename OffsetT, bool IsString>
+class VarBinaryKernel : public ColumnKernel {
 public:
-  using InsertHelper::InsertHelper;
+  using ColumnKernel::ColumnKernel;
 
-  void InsertValueAtIndex(int64_t idx) override {
-    if (CheckNull(idx)) {
-      InsertNull<hyperapi::ByteSpan>();
-      return;
+  using value_t = typename std::conditional<IsString, char, uint8_t>::type;
+
+  auto Bind(const struct ArrowArray *array, struct ArrowError *error) -> void {
+    ColumnKernel::Bind(array, error);
+    offsets_ = GetValues<OffsetT>();
+    const auto data_view = GetArrayView()->buffer_views[2];
+    data_ = std::span{static_cast<const value_t *>(data_view.data.data),
+                      static_cast<size_t>(data_view.size_bytes)};
+  }
+
+  auto InsertNull(hyperapi::Inserter &inserter) const -> void {
+    if constexpr (IsString) {
+      inserter.add(hyperapi::optional<hyperapi::string_view>{});
+    } else {
+      inserter.add(hyperapi::optional<hyperapi::ByteSpan>{});
     }
+  }
 
-    const struct ArrowBufferView buffer_view =
-        ArrowArrayViewGetBytesUnsafe(GetArrayView(), idx);
-    const hyperapi::ByteSpan result{
-        buffer_view.data.as_uint8, static_cast<size_t>(buffer_view.size_bytes)};
-    InsertValue(std::move(result));
+  auto InsertValue(hyperapi::Inserter &inserter, int64_t idx) const -> void {
+    const auto value = GetValue(idx);
+    if constexpr (IsString) {
+      inserter.add(hyperapi::string_view{value.data(), value.size()});
+    } else {
+      inserter.add(hyperapi::ByteSpan{value.data(), value.size()});
+    }
   }
-};
 
-template <typename OffsetT> class Utf8InsertHelper : public InsertHelper {
-public:
-  using InsertHelper::InsertHelper;
+  // binary values have no ordering in Hyper, so only strings keep a range
 
-  void InsertValueAtIndex(int64_t idx) override {
-    if (CheckNull(idx)) {
-      InsertNull<hyperapi::string_view>();
-      return;
+  auto Observe(int64_t idx) -> void {
+    if constexpr (IsString) {
+      const auto value = GetValue(idx);
+      chunk_range_.Update(std::string_view{value.data(), value.size()});
+    }
+  }
+
+  auto SettleRange() -> void {
+    if constexpr (IsString) {
+      range_.Merge(chunk_range_);
+      chunk_range_.Reset();
+    }
+  }
+
+  auto TakeRange(ColumnStatistics &stats) -> void {
+    if constexpr (IsString) {
+      SettleRange();
+      range_.Take(stats, [](const std::string &value) { return value; });
     }
+  }
 
-    const struct ArrowBufferView buffer_view =
-        ArrowArrayViewGetBytesUnsafe(GetArrayView(), idx);
-    const hyperapi::string_view result{
-        buffer_view.data.as_char, static_cast<size_t>(buffer_view.size_bytes)};
-    InsertValue(std::move(result));
+private:
+  auto GetValue(int64_t idx) const -> std::span<const value_t> {
+    const auto start = static_cast<size_t>(offsets_[static_cast<size_t>(idx)]);
+    const auto stop =
+        static_cast<size_t>(offsets_[static_cast<size_t>(idx) + 1]);
+    return data_.subspan(start, stop - start);
   }
+
+  std::span<const OffsetT> offsets_;
+  std::span<const value_t> data_;
+  // the range of the bound chunk only points into its buffers, so that a
+  // new extreme value does not cost a copy
+  ValueRange<std::string_view> chunk_range_;
+  ValueRange<std::string> range_;
 };
 
-template <bool IsString> class BinaryViewInsertHelper : public InsertHelper {
+template <bool IsString> class BinaryViewKernel : public ColumnKernel {
 public:
-  using InsertHelper::InsertHelper;
+  using ColumnKernel::ColumnKernel;
 
-  void InsertValueAtIndex(int64_t idx) override {
-    if (CheckNull(idx)) {
-      if constexpr (IsString) {
-        InsertNull<hyperapi::string_view>();
-      } else {
-        InsertNull<hyperapi::ByteSpan>();
-      }
-      return;
+  auto Bind(const struct ArrowArray *array, struct ArrowError *error) -> void {
+    ColumnKernel::Bind(array, error);
+    views_ = GetValues<union ArrowBinaryView>();
+    buffers_ = std::span{GetArrayView()->array->buffers,
+                         static_cast<size_t>(GetArrayView()->array->n_buffers)};
+  }
+
+  auto InsertNull(hyperapi::Inserter &inserter) const -> void {
+    if constexpr (IsString) {
+      inserter.add(hyperapi::optional<hyperapi::string_view>{});
+    } else {
+      inserter.add(hyperapi::optional<hyperapi::ByteSpan>{});
+    }
+  }
+
+  auto InsertValue(hyperapi::Inserter &inserter, int64_t idx) const -> void {
+    const auto bin_data = GetValue(idx);
+    if constexpr (IsString) {
+      inserter.add(hyperapi::string_view{
+          bin_data.data.as_char, static_cast<size_t>(bin_data.size_bytes)});
+    } else {
+      inserter.add(hyperapi::ByteSpan{
+          bin_data.data.as_uint8, static_cast<size_t>(bin_data.size_bytes)});
     }
+  }
 
-    const auto view_offset = GetArrayView()->offset;
-    const auto buf_view = GetArrayView()->buffer_views[1];
+  auto Observe(int64_t idx) -> void {
+    if constexpr (IsString) {
+      const auto bin_data = GetValue(idx);
+      chunk_range_.Update(std::string_view{
+          bin_data.data.as_char, static_cast<size_t>(bin_data.size_bytes)});
+    }
+  }
 
-    const std::span raw_span{buf_view.data.as_binary_view,
-                             static_cast<size_t>(buf_view.size_bytes)};
-    const auto view_data = raw_span.subspan(view_offset);
+  auto SettleRange() -> void {
+    if constexpr (IsString) {
+      range_.Merge(chunk_range_);
+      chunk_range_.Reset();
+    }
+  }
 
-    const std::span buffers{
-        GetArrayView()->array->buffers,
-        static_cast<size_t>(GetArrayView()->array->n_buffers)};
+  auto TakeRange(ColumnStatistics &stats) -> void {
+    if constexpr (IsString) {
+      SettleRange();
+      range_.Take(stats, [](const std::string &value) { return value; });
+    }
+  }
 
-    const union ArrowBinaryView bv = view_data[idx];
+private:
+  auto GetValue(int64_t idx) const -> struct ArrowBufferView {
+    // inlined values are returned in place, so the view must not be copied
+    const union ArrowBinaryView &bv = views_[static_cast<size_t>(idx)];
     struct ArrowBufferView bin_data = {{NULL}, bv.inlined.size};
     if (bv.inlined.size <= NANOARROW_BINARY_VIEW_INLINE_SIZE) {
       bin_data.data.as_uint8 = &bv.inlined.data[0];
     } else {
       const int32_t buf_index =
           bv.ref.buffer_index + NANOARROW_BINARY_VIEW_FIXED_BUFFERS;
-      bin_data.data.data = buffers[buf_index];
+      bin_data.data.data = buffers_[buf_index];
       const std::span bin_span{bin_data.data.as_uint8,
                                static_cast<size_t>(bin_data.size_bytes)};
       bin_data.data.as_uint8 = &bin_span[bv.ref.offset];
     }
-
-    if constexpr (IsString) {
-#if defined(_WIN32) && defined(_MSC_VER)
-      const std::string result(bin_data.data.as_char,
-                               static_cast<size_t>(bin_data.size_bytes));
-#else
-      const std::string_view result{bin_data.data.as_char,
-                                    static_cast<size_t>(bin_data.size_bytes)};
-#endif
-      InsertValue(std::move(result));
-    } else {
-      const hyperapi::ByteSpan result{bin_data.data.as_uint8,
-                                      static_cast<size_t>(bin_data.size_bytes)};
-      InsertValue(std::move(result));
-    }
+    return bin_data;
   }
+
+  std::span<const union ArrowBinaryView> views_;
+  std::span<const void *> buffers_;
+  ValueRange<std::string_view> chunk_range_;
+  ValueRange<std::string> range_;
 };
 
-class Date32InsertHelper : public InsertHelper {
+class Date32Kernel : public ColumnKernel {
 public:
-  using InsertHelper::InsertHelper;
-
-  void InsertValueAtIndex(int64_t idx) override {
-    constexpr size_t elem_size = sizeof(int32_t);
-    if (CheckNull(idx)) {
-      InsertNull<hyperapi::Date>();
-      return;
+  using ColumnKernel::ColumnKernel;
+
+  auto Bind(const struct ArrowArray *array, struct ArrowError *error) -> void {
+    ColumnKernel::Bind(array, error);
+    const auto values = GetValues<int32_t>().first(
+        static_cast<size_t>(GetArrayView()->length));
+    julian_days_.resize(values.size());
+    if (temporal::ToJulianDays(values, julian_days_)) {
+      CheckRange(
+          values,
+          [](int32_t value) { return value >= -temporal::UnixEpochJulianDay; },
+          "DATE");
     }
+  }
+
+  auto InsertNull(hyperapi::Inserter &inserter) const -> void {
+    inserter.add(hyperapi::optional<hyperapi::Date>{});
+  }
+
+  auto InsertValue(hyperapi::Inserter &inserter, int64_t idx) const -> void {
+    const hyper_date_t raw_date = julian_days_[static_cast<size_t>(idx)];
+    inserter.add(hyperapi::Date{raw_date, {}});
+  }
 
-    int32_t value{};
+  auto Observe(int64_t idx) -> void {
+    range_.Update(julian_days_[static_cast<size_t>(idx)]);
+  }
 
-    const auto view_offset = GetArrayView()->offset * elem_size;
-    const auto buf_view = GetArrayView()->buffer_views[1];
-    const std::span raw_span{buf_view.data.as_uint8,
-                             static_cast<size_t>(buf_view.size_bytes)};
-    const auto view_data = raw_span.subspan(view_offset);
-    memcpy(&value, &view_data[idx * elem_size], elem_size);
+  auto TakeRange(ColumnStatistics &stats) -> void {
+    range_.Take(stats, [](hyper_date_t value) { return FormatDate(value); });
+  }
 
-    const std::chrono::duration<int32_t, std::ratio<86400>> dur{value};
-    const std::chrono::time_point<
-        std::chrono::system_clock,
-        std::chrono::duration<int32_t, std::ratio<86400>>>
-        tp{dur};
+private:
+  std::vector<uint32_t> julian_days_;
+  ValueRange<hyper_date_t> range_;
+};
 
-    const auto dp = std::chrono::floor<std::chrono::days>(tp);
-    const auto ymd = std::chrono::year_month_day{dp};
+///
+/// Scales a whole column of TU values to offset microseconds, throwing if a
+/// valid value lands outside of [0, limit]
+///
+template <enum ArrowTimeUnit TU>
+class MicrosecondsKernel : public ColumnKernel {
+public:
+  MicrosecondsKernel(const struct ArrowSchema *schema, struct ArrowError *error,
+                     int64_t offset, int64_t limit,
+                     std::string_view hyper_type)
+      : ColumnKernel(schema, error), offset_{offset},
+        bounds_{temporal::MicrosecondBounds<TU>(offset, limit)},
+        hyper_type_{hyper_type} {}
+
+  auto Bind(const struct ArrowArray *array, struct ArrowError *error) -> void {
+    ColumnKernel::Bind(array, error);
+    const auto values = GetValues<int64_t>().first(
+        static_cast<size_t>(GetArrayView()->length));
+    microseconds_.resize(values.size());
+    if (temporal::ToMicroseconds<TU>(values, offset_, bounds_,
+                                     microseconds_)) {
+      CheckRange(
+          values,
+          [bounds = bounds_](int64_t value) {
+            return value >= bounds.lower && value <= bounds.upper;
+          },
+          hyper_type_);
+    }
+  }
 
-    using YearT = decltype(std::declval<hyperapi::Date>().getYear());
-    using MonthT = decltype(std::declval<hyperapi::Date>().getMonth());
-    using DayT = decltype(std::declval<hyperapi::Date>().getDay());
-    hyperapi::Date dt{static_cast<YearT>(ymd.year()),
-                      static_cast<MonthT>(static_cast<unsigned>(ymd.month())),
-                      static_cast<DayT>(static_cast<unsigned>(ymd.day()))};
+  auto Observe(int64_t idx) -> void { range_.Update(GetMicroseconds(idx)); }
 
-    InsertValue(std::move(dt));
+protected:
+  auto GetMicroseconds(int64_t idx) const -> int64_t {
+    return microseconds_[static_cast<size_t>(idx)];
   }
-};
 
-static constexpr int64_t MicrosecondsPerSecond = 1'000'000;
-static constexpr int64_t MicrosecondsPerMillisecond = 1'000;
-static constexpr int64_t NanosecondsPerMicrosecond = 1'000;
+  auto GetRange() -> ValueRange<int64_t> & { return range_; }
+
+private:
+  int64_t offset_;
+  temporal::Bounds bounds_;
+  std::string_view hyper_type_;
+  std::vector<int64_t> microseconds_;
+  ValueRange<int64_t> range_;
+};
 
-template <enum ArrowTimeUnit TU> class TimeInsertHelper : public InsertHelper {
+template <enum ArrowTimeUnit TU>
+class TimeKernel : public MicrosecondsKernel<TU> {
 public:
-  using InsertHelper::InsertHelper;
+  TimeKernel(const struct ArrowSchema *schema, struct ArrowError *error)
+      : MicrosecondsKernel<TU>(schema, error, 0, temporal::MicrosecondsPerDay,
+                               "TIME") {}
 
-  void InsertValueAtIndex(int64_t idx) override {
-    if (CheckNull(idx)) {
-      InsertNull<hyperapi::Time>();
-      return;
-    }
+  auto InsertNull(hyperapi::Inserter &inserter) const -> void {
+    inserter.add(hyperapi::optional<hyperapi::Time>{});
+  }
 
-    int64_t value = ArrowArrayViewGetIntUnsafe(GetArrayView(), idx);
-    // TODO: check for overflow in these branches
-    if constexpr (TU == NANOARROW_TIME_UNIT_SECOND) {
-      value *= MicrosecondsPerSecond;
-    } else if constexpr (TU == NANOARROW_TIME_UNIT_MILLI) {
-      value *= MicrosecondsPerMillisecond;
-    } else if constexpr (TU == NANOARROW_TIME_UNIT_NANO) {
-      value /= NanosecondsPerMicrosecond;
-    }
-    InsertValue(hyperapi::Time{static_cast<hyper_time_t>(value), {}});
+  auto InsertValue(hyperapi::Inserter &inserter, int64_t idx) const -> void {
+    const auto raw_time = static_cast<hyper_time_t>(this->GetMicroseconds(idx));
+    inserter.add(hyperapi::Time{raw_time, {}});
+  }
+
+  auto TakeRange(ColumnStatistics &stats) -> void {
+    this->GetRange().Take(stats, FormatTime);
   }
 };
 
 template <enum ArrowTimeUnit TU, bool TZAware>
-class TimestampInsertHelper : public InsertHelper {
+class TimestampKernel : public MicrosecondsKernel<TU> {
 public:
-  using InsertHelper::InsertHelper;
+  TimestampKernel(const struct ArrowSchema *schema, struct ArrowError *error)
+      : MicrosecondsKernel<TU>(schema, error,
+                               temporal::UnixEpochJulianMicroseconds,
+                               std::numeric_limits<int64_t>::max(),
+                               TZAware ? "TIMESTAMP_TZ" : "TIMESTAMP") {}
 
   using timestamp_t =
       typename std::conditional<TZAware, hyperapi::OffsetTimestamp,
                                 hyperapi::Timestamp>::type;
 
-  void InsertValueAtIndex(int64_t idx) override {
-    constexpr size_t elem_size = sizeof(int64_t);
-    if (CheckNull(idx)) {
-      InsertNull<timestamp_t>();
-      return;
-    }
-
-    int64_t value{};
-
-    const auto view_offset = GetArrayView()->offset * elem_size;
-    const auto buf_view = GetArrayView()->buffer_views[1];
-    const std::span raw_span{buf_view.data.as_uint8,
-                             static_cast<size_t>(buf_view.size_bytes)};
-    const auto view_data = raw_span.subspan(view_offset);
-    memcpy(&value, &view_data[idx * elem_size], elem_size);
-
-    // TODO: need overflow checks here
-    if constexpr (TU == NANOARROW_TIME_UNIT_SECOND) {
-      value *= MicrosecondsPerSecond;
-    } else if constexpr (TU == NANOARROW_TIME_UNIT_MILLI) {
-      value *= MicrosecondsPerMillisecond;
-    } else if constexpr (TU == NANOARROW_TIME_UNIT_NANO) {
-      value /= NanosecondsPerMicrosecond;
-    }
+  auto InsertNull(hyperapi::Inserter &inserter) const -> void {
+    inserter.add(hyperapi::optional<timestamp_t>{});
+  }
 
-    constexpr int64_t USEC_TABLEAU_TO_UNIX_EPOCH = 210866803200000000LL;
-    hyper_timestamp_t raw_timestamp =
-        static_cast<hyper_timestamp_t>(value + USEC_TABLEAU_TO_UNIX_EPOCH);
+  auto InsertValue(hyperapi::Inserter &inserter, int64_t idx) const -> void {
+    const auto raw_timestamp =
+        static_cast<hyper_timestamp_t>(this->GetMicroseconds(idx));
+    inserter.add(timestamp_t{raw_timestamp, {}});
+  }
 
-    const timestamp_t ts{raw_timestamp, {}};
-    InsertValue(std::move(static_cast<timestamp_t>(ts)));
+  auto TakeRange(ColumnStatistics &stats) -> void {
+    this->GetRange().Take(stats, FormatTimestamp<TZAware>);
   }
 };
 
-class IntervalInsertHelper : public InsertHelper {
+class IntervalKernel : public ColumnKernel {
 public:
-  using InsertHelper::InsertHelper;
+  using ColumnKernel::ColumnKernel;
 
-  void InsertValueAtIndex(int64_t idx) override {
-    if (CheckNull(idx)) {
-      InsertNull<hyperapi::Interval>();
-      return;
-    }
+  auto InsertNull(hyperapi::Inserter &inserter) const -> void {
+    inserter.add(hyperapi::optional<hyperapi::Interval>{});
+  }
 
+  auto InsertValue(hyperapi::Inserter &inserter, int64_t idx) const -> void {
     struct ArrowInterval arrow_interval {};
     ArrowIntervalInit(&arrow_interval, NANOARROW_TYPE_INTERVAL_MONTH_DAY_NANO);
     ArrowArrayViewGetIntervalUnsafe(GetArrayView(), idx, &arrow_interval);
     const auto usec = static_cast<int32_t>(arrow_interval.ns / 1000);
 
-    hyperapi::Interval interval(0, arrow_interval.months, arrow_interval.days,
-                                0, 0, 0, usec);
-    InsertValue(std::move(interval));
+    const hyperapi::Interval interval(0, arrow_interval.months,
+                                      arrow_interval.days, 0, 0, 0, usec);
+    inserter.add(interval);
   }
 };
 
-class DecimalInsertHelper : public InsertHelper {
+template <size_t P, size_t S>
+static auto InsertNumericNull(hyperapi::Inserter &inserter) -> void {
+  inserter.add(hyperapi::optional<hyperapi::Numeric<P, S>>{});
+}
+
+///
+/// Hyper stores numerics as their unscaled integer, in 64 bits up to a
+/// precision of 18 and in 128 bits (least significant word first) beyond
+/// that, so Arrow's unscaled decimal128 value is handed over as is. The raw
+/// constructor does not validate its input, so the value must already be
+/// known to fit P digits.
+///
+template <size_t P, size_t S>
+static auto MakeNumeric(const decimal_codec::Decimal128 &value)
+    -> hyperapi::Numeric<P, S> {
+  if constexpr (P <= decimal_codec::MaxInt64Precision) {
+    // values of this precision fit in the low word
+    const auto raw = static_cast<int64_t>(value.low);
+    return {raw, hyperapi::raw_t{}};
+  } else {
+    const hyper_data128_t raw{{value.low, value.high}};
+    return {raw, hyperapi::raw_t{}};
+  }
+}
+
+template <size_t P, size_t S>
+static auto InsertNumericRaw(hyperapi::Inserter &inserter,
+                             const decimal_codec::Decimal128 &value) -> void {
+  inserter.add(MakeNumeric<P, S>(value));
+}
+
+template <size_t P, size_t S>
+static auto FormatNumeric(const decimal_codec::Decimal128 &value)
+    -> std::string {
+  return MakeNumeric<P, S>(value).toString();
+}
+
+class DecimalKernel : public ColumnKernel {
 public:
-  DecimalInsertHelper(hyperapi::Inserter &inserter,
-                      const struct ArrowArray *chunk,
-                      const struct ArrowSchema *schema,
-                      struct ArrowError *error, int64_t column_position,
-                      int32_t precision, int32_t scale)
-      : InsertHelper(inserter, chunk, schema, error, column_position),
-        precision_(precision), scale_(scale) {}
-
-  void InsertValueAtIndex(int64_t idx) override {
-    constexpr auto PrecisionLimit = 39; // of-by-one error in solution?
-    if (precision_ >= PrecisionLimit) {
+  DecimalKernel(const struct ArrowSchema *schema, struct ArrowError *error,
+                int32_t precision, int32_t scale)
+      : ColumnKernel(schema, error), precision_{precision}, scale_{scale} {
+    if (precision >= PrecisionLimit) {
       throw nb::value_error("Numeric precision may not exceed 38!");
     }
-    if (scale_ >= PrecisionLimit) {
+    if (scale >= PrecisionLimit) {
       throw nb::value_error("Numeric scale may not exceed 38!");
     }
 
-    if (CheckNull(idx)) {
-      std::visit(
-          [&](auto P, auto S) {
-            if constexpr (S() <= P()) {
-              InsertNull<hyperapi::Numeric<P(), S()>>();
-              return;
-            } else {
-              throw "unreachable";
-            }
-          },
-          to_integral_variant<PrecisionLimit>(precision_),
-          to_integral_variant<PrecisionLimit>(scale_));
-      return;
-    }
-
-    constexpr int32_t bitwidth = 128;
-    struct ArrowDecimal decimal {};
-    ArrowDecimalInit(&decimal, bitwidth, precision_, scale_);
-    ArrowArrayViewGetDecimalUnsafe(GetArrayView(), idx, &decimal);
-
-    struct ArrowBuffer buffer {};
-    ArrowBufferInit(&buffer);
-    if (ArrowDecimalAppendDigitsToBuffer(&decimal, &buffer)) {
-      throw std::runtime_error("could not create buffer from decmial value");
-    }
-
-    const std::span bufspan{buffer.data,
-                            static_cast<size_t>(buffer.size_bytes)};
-    std::string str{bufspan.begin(), bufspan.end()};
-
-    // The Hyper API wants the string to include the decimal place, which
-    // nanoarrow does not provide.
-    if (scale_ > 0) {
-      // nanoarrow strips leading zeros
-      const auto insert_pos = static_cast<int64_t>(str.size()) - scale_;
-      if (insert_pos < 0) {
-        std::string newstr{};
-        newstr.reserve(str.size() - insert_pos + 1);
-        newstr.append(1, '.');
-        newstr.append(-insert_pos, '0');
-        newstr.append(str);
-        str = std::move(newstr);
-      } else {
-        str = str.insert(str.size() - scale_, 1, '.');
-      }
-    }
-
+    // Resolve the Numeric<P, S> specialization once for the column rather
+    // than visiting the precision / scale variants for every value
     std::visit(
         [&](auto P, auto S) {
           if constexpr (S() <= P()) {
-            const auto value = hyperapi::Numeric<P(), S()>{str};
-            InsertValue(std::move(value));
-            return;
+            insert_null_ = &InsertNumericNull<P(), S()>;
+            insert_raw_ = &InsertNumericRaw<P(), S()>;
+            format_ = &FormatNumeric<P(), S()>;
           } else {
-            throw "unreachable";
+            throw nb::value_error("Numeric scale may not exceed precision!");
           }
         },
-        to_integral_variant<PrecisionLimit>(precision_),
-        to_integral_variant<PrecisionLimit>(scale_));
+        to_integral_variant<PrecisionLimit>(precision),
+        to_integral_variant<PrecisionLimit>(scale));
+  }
+
+  auto Bind(const struct ArrowArray *array, struct ArrowError *error) -> void {
+    ColumnKernel::Bind(array, error);
+    values_ = GetValues<decimal_codec::Decimal128Storage>().first(
+        static_cast<size_t>(GetArrayView()->length));
+
+    // Arrow producers do not guarantee that a decimal fits its declared
+    // precision, and Hyper takes raw numerics as they are. Null slots may
+    // hold arbitrary values, so only valid ones are rejected.
+    bool out_of_range = false;
+    for (const auto &value : values_) {
+      out_of_range |= !decimal_codec::FitsPrecision(
+          decimal_codec::FromStorage(value), precision_);
+    }
+    if (!out_of_range) {
+      return;
+    }
+    for (size_t i = 0; i < values_.size(); i++) {
+      if (!decimal_codec::FitsPrecision(decimal_codec::FromStorage(values_[i]),
+                                        precision_) &&
+          IsValid(static_cast<int64_t>(i))) {
+        throw nb::value_error(("A value in column '" + GetName() +
+                               "' exceeds the precision of NUMERIC(" +
+                               std::to_string(precision_) + ", " +
+                               std::to_string(scale_) + ")")
+                                  .c_str());
+      }
+    }
+  }
+
+  auto InsertNull(hyperapi::Inserter &inserter) const -> void {
+    insert_null_(inserter);
+  }
+
+  auto InsertValue(hyperapi::Inserter &inserter, int64_t idx) const -> void {
+    insert_raw_(inserter,
+                decimal_codec::FromStorage(values_[static_cast<size_t>(idx)]));
+  }
+
+  auto Observe(int64_t idx) -> void {
+    range_.Update(
+        decimal_codec::FromStorage(values_[static_cast<size_t>(idx)]));
+  }
 
-    ArrowBufferReset(&buffer);
+  auto TakeRange(ColumnStatistics &stats) -> void {
+    range_.Take(stats, format_);
   }
 
 private:
+  // Hyper numerics hold at most 38 digits, so precision and scale are
+  // dispatched over the Numeric<P, S> specializations in [0, 39)
+  static constexpr auto PrecisionLimit = decimal_codec::MaxPrecision + 1;
   int32_t precision_;
   int32_t scale_;
+  std::span<const decimal_codec::Decimal128Storage> values_;
+  void (*insert_null_)(hyperapi::Inserter &){};
+  void (*insert_raw_)(hyperapi::Inserter &,
+                      const decimal_codec::Decimal128 &){};
+  std::string (*format_)(const decimal_codec::Decimal128 &){};
+  ValueRange<decimal_codec::Decimal128> range_;
 };
 
-class DictionaryInsertHelper : public InsertHelper {
+///
+/// Dictionary columns resolve every dictionary entry to its Hyper value once
+/// per chunk, so each row only costs an index lookup. The table of resolved
+/// values keeps its allocation from one chunk to the next.
+///
+template <typename HyperT> class DictionaryKernel : public ColumnKernel {
 public:
-  using InsertHelper::InsertHelper;
+  using ColumnKernel::ColumnKernel;
 
-  void InsertValueAtIndex(int64_t idx) override {
-    if (CheckNull(idx)) {
-      InsertNull<hyperapi::Time>();
-      return;
+  auto Bind(const struct ArrowArray *array, struct ArrowError *error) -> void {
+    ColumnKernel::Bind(array, error);
+
+    const auto *dictionary = GetArrayView()->dictionary;
+    values_.resize(static_cast<size_t>(dictionary->length));
+    for (size_t i = 0; i < values_.size(); i++) {
+      const auto idx = static_cast<int64_t>(i);
+      if (ArrowArrayViewIsNull(dictionary, idx)) {
+        values_[i].reset();
+      } else {
+        values_[i] = ResolveValue(dictionary, idx);
+      }
     }
+  }
+
+  auto InsertNull(hyperapi::Inserter &inserter) const -> void {
+    inserter.add(hyperapi::optional<HyperT>{});
+  }
 
+  auto InsertValue(hyperapi::Inserter &inserter, int64_t idx) const -> void {
     const auto key = ArrowArrayViewGetIntUnsafe(GetArrayView(), idx);
-    const auto value =
-        ArrowArrayViewGetStringUnsafe(GetArrayView()->dictionary, key);
+    inserter.add(values_[static_cast<size_t>(key)]);
+  }
+
+  auto Observe(int64_t idx) -> void {
+    const auto key = ArrowArrayViewGetIntUnsafe(GetArrayView(), idx);
+    const auto &value = values_[static_cast<size_t>(key)];
+    if (!value) {
+      // a valid key can still refer to a null dictionary entry
+      null_entries_++;
+    } else if constexpr (std::is_same_v<HyperT, hyperapi::string_view>) {
+      chunk_range_.Update(std::string_view{value->data(), value->size()});
+    } else if constexpr (std::is_same_v<HyperT, hyperapi::Date>) {
+      range_.Update(value->getRaw());
+    } else if constexpr (!std::is_same_v<HyperT, hyperapi::ByteSpan>) {
+      range_.Update(*value);
+    }
+  }
+
+  auto SettleRange() -> void {
+    if constexpr (std::is_same_v<HyperT, hyperapi::string_view>) {
+      range_.Merge(chunk_range_);
+      chunk_range_.Reset();
+    }
+  }
+
+  auto TakeRange(ColumnStatistics &stats) -> void {
+    SettleRange();
+    stats.null_count += null_entries_;
+    null_entries_ = 0;
+    if constexpr (std::is_same_v<HyperT, hyperapi::Date>) {
+      range_.Take(stats, [](hyper_date_t value) { return FormatDate(value); });
+    } else if constexpr (std::is_integral_v<HyperT>) {
+      range_.Take(stats, FormatNumber<HyperT>);
+    } else {
+      range_.Take(stats, [](const std::string &value) { return value; });
+    }
+  }
 
-    const hyperapi::string_view result{value.data,
-                                       static_cast<size_t>(value.size_bytes)};
-    InsertValue(std::move(result));
+private:
+  // strings are ranged as text, dates by their Julian day number
+  using range_t = std::conditional_t<
+      std::is_same_v<HyperT, hyperapi::Date>, hyper_date_t,
+      std::conditional_t<std::is_integral_v<HyperT>, HyperT, std::string>>;
+
+  auto ResolveValue(const struct ArrowArrayView *dictionary, int64_t idx) const
+      -> HyperT {
+    if constexpr (std::is_same_v<HyperT, hyperapi::string_view>) {
+      const auto value = ArrowArrayViewGetStringUnsafe(dictionary, idx);
+      return {value.data, static_cast<size_t>(value.size_bytes)};
+    } else if constexpr (std::is_same_v<HyperT, hyperapi::ByteSpan>) {
+      const auto value = ArrowArrayViewGetBytesUnsafe(dictionary, idx);
+      return {value.data.as_uint8, static_cast<size_t>(value.size_bytes)};
+    } else if constexpr (std::is_same_v<HyperT, hyperapi::Date>) {
+      const auto days = ArrowArrayViewGetIntUnsafe(dictionary, idx);
+      if (days < -temporal::UnixEpochJulianDay) {
+        throw std::invalid_argument(
+            "Value " + std::to_string(days) + " in the dictionary of column '" +
+            GetName() + "' is out of range for Hyper type DATE");
+      }
+      const auto raw_date =
+          static_cast<hyper_date_t>(days + temporal::UnixEpochJulianDay);
+      return {raw_date, {}};
+    } else {
+      return static_cast<HyperT>(ArrowArrayViewGetIntUnsafe(dictionary, idx));
+    }
   }
+
+  // indexed by dictionary key; null dictionary entries stay empty
+  std::vector<hyperapi::optional<HyperT>> values_;
+  ValueRange<std::string_view> chunk_range_;
+  ValueRange<range_t> range_;
+  int64_t null_entries_{};
 };
 
-static auto MakeInsertHelper(hyperapi::Inserter &inserter,
-                             struct ArrowArray *chunk,
-                             const struct ArrowSchema *schema,
-                             struct ArrowError *error, int64_t column_position)
-    -> std::unique_ptr<InsertHelper> {
+using ColumnKernelVariant =
+    std::variant<PrimitiveKernel<int8_t, int16_t>,
+                 PrimitiveKernel<int16_t, int16_t>,
+                 PrimitiveKernel<int32_t, int32_t>,
+                 PrimitiveKernel<int64_t, int64_t>,
+                 PrimitiveKernel<uint32_t, uint32_t>,
+                 PrimitiveKernel<float, float>,
+                 PrimitiveKernel<double, double>, BooleanKernel,
+                 VarBinaryKernel<int32_t, false>,
+                 VarBinaryKernel<int64_t, false>,
+                 VarBinaryKernel<int32_t, true>, VarBinaryKernel<int64_t, true>,
+                 BinaryViewKernel<false>, BinaryViewKernel<true>, Date32Kernel,
+                 TimeKernel<NANOARROW_TIME_UNIT_SECOND>,
+                 TimeKernel<NANOARROW_TIME_UNIT_MILLI>,
+                 TimeKernel<NANOARROW_TIME_UNIT_MICRO>,
+                 TimeKernel<NANOARROW_TIME_UNIT_NANO>,
+                 TimestampKernel<NANOARROW_TIME_UNIT_SECOND, false>,
+                 TimestampKernel<NANOARROW_TIME_UNIT_SECOND, true>,
+                 TimestampKernel<NANOARROW_TIME_UNIT_MILLI, false>,
+                 TimestampKernel<NANOARROW_TIME_UNIT_MILLI, true>,
+                 TimestampKernel<NANOARROW_TIME_UNIT_MICRO, false>,
+                 TimestampKernel<NANOARROW_TIME_UNIT_MICRO, true>,
+                 TimestampKernel<NANOARROW_TIME_UNIT_NANO, false>,
+                 TimestampKernel<NANOARROW_TIME_UNIT_NANO, true>,
+                 IntervalKernel, DecimalKernel,
+                 DictionaryKernel<hyperapi::string_view>,
+                 DictionaryKernel<hyperapi::ByteSpan>,
+                 DictionaryKernel<int16_t>, DictionaryKernel<int32_t>,
+                 DictionaryKernel<int64_t>, DictionaryKernel<hyperapi::Date>>;
+
+template <typename KernelT, typename... Args>
+static auto MakeKernel(Args &&...args) -> ColumnKernelVariant {
+  return ColumnKernelVariant{std::in_place_type<KernelT>,
+                             std::forward<Args>(args)...};
+}
+
+template <enum ArrowTimeUnit TU>
+static auto MakeTimestampKernel(const struct ArrowSchema *schema,
+                                struct ArrowError *error, bool tz_aware)
+    -> ColumnKernelVariant {
+  if (tz_aware) {
+    return MakeKernel<TimestampKernel<TU, true>>(schema, error);
+  }
+  return MakeKernel<TimestampKernel<TU, false>>(schema, error);
+}
+
+static auto MakeColumnKernel(const struct ArrowSchema *schema,
+                             struct ArrowError *error) -> ColumnKernelVariant {
   struct ArrowSchemaView schema_view {};
-  std::span children{schema->children, static_cast<size_t>(schema->n_children)};
-  const struct ArrowSchema *child_schema = children[column_position];
-  if (ArrowSchemaViewInit(&schema_view, child_schema, error) != 0) {
-    throw std::runtime_error("Issue generating insert helper: " +
+  if (ArrowSchemaViewInit(&schema_view, schema, error) != 0) {
+    throw std::runtime_error("Issue generating column kernel: " +
                              std::string(&error->message[0]));
   }
 
   switch (schema_view.type) {
   case NANOARROW_TYPE_INT8:
+    return MakeKernel<PrimitiveKernel<int8_t, int16_t>>(schema, error);
   case NANOARROW_TYPE_INT16:
-    return std::make_unique<IntegralInsertHelper<int16_t>>(
-        inserter, chunk, child_schema, error, column_position);
+    return MakeKernel<PrimitiveKernel<int16_t, int16_t>>(schema, error);
   case NANOARROW_TYPE_INT32:
-    return std::make_unique<IntegralInsertHelper<int32_t>>(
-        inserter, chunk, child_schema, error, column_position);
+    return MakeKernel<PrimitiveKernel<int32_t, int32_t>>(schema, error);
   case NANOARROW_TYPE_INT64:
-    return std::make_unique<IntegralInsertHelper<int64_t>>(
-        inserter, chunk, child_schema, error, column_position);
+    return MakeKernel<PrimitiveKernel<int64_t, int64_t>>(schema, error);
   case NANOARROW_TYPE_UINT32:
-    return std::make_unique<UInt32InsertHelper>(inserter, chunk, child_schema,
-                                                error, column_position);
+    return MakeKernel<PrimitiveKernel<uint32_t, uint32_t>>(schema, error);
   case NANOARROW_TYPE_FLOAT:
-    return std::make_unique<FloatingInsertHelper<float>>(
-        inserter, chunk, child_schema, error, column_position);
+    return MakeKernel<PrimitiveKernel<float, float>>(schema, error);
   case NANOARROW_TYPE_DOUBLE:
-    return std::make_unique<FloatingInsertHelper<double>>(
-        inserter, chunk, child_schema, error, column_position);
+    return MakeKernel<PrimitiveKernel<double, double>>(schema, error);
   case NANOARROW_TYPE_BOOL:
-    return std::make_unique<IntegralInsertHelper<bool>>(
-        inserter, chunk, child_schema, error, column_position);
+    return MakeKernel<BooleanKernel>(schema, error);
   case NANOARROW_TYPE_BINARY:
+    return MakeKernel<VarBinaryKernel<int32_t, false>>(schema, error);
   case NANOARROW_TYPE_LARGE_BINARY:
-    return std::make_unique<BinaryInsertHelper>(inserter, chunk, child_schema,
-                                                error, column_position);
+    return MakeKernel<VarBinaryKernel<int64_t, false>>(schema, error);
   case NANOARROW_TYPE_STRING:
+    return MakeKernel<VarBinaryKernel<int32_t, true>>(schema, error);
   case NANOARROW_TYPE_LARGE_STRING:
-    return std::make_unique<Utf8InsertHelper<int64_t>>(
-        inserter, chunk, child_schema, error, column_position);
+    return MakeKernel<VarBinaryKernel<int64_t, true>>(schema, error);
   case NANOARROW_TYPE_DATE32:
-    return std::make_unique<Date32InsertHelper>(inserter, chunk, child_schema,
-                                                error, column_position);
-  case NANOARROW_TYPE_TIMESTAMP:
+    return MakeKernel<Date32Kernel>(schema, error);
+  case NANOARROW_TYPE_TIMESTAMP: {
+    const bool tz_aware = std::strcmp("", schema_view.timezone) != 0;
     switch (schema_view.time_unit) {
     case NANOARROW_TIME_UNIT_SECOND:
-      if (std::strcmp("", schema_view.timezone)) {
-        return std::make_unique<
-            TimestampInsertHelper<NANOARROW_TIME_UNIT_SECOND, true>>(
-            inserter, chunk, child_schema, error, column_position);
-      } else {
-        return std::make_unique<
-            TimestampInsertHelper<NANOARROW_TIME_UNIT_SECOND, false>>(
-            inserter, chunk, child_schema, error, column_position);
-      }
+      return MakeTimestampKernel<NANOARROW_TIME_UNIT_SECOND>(schema, error,
+                                                             tz_aware);
     case NANOARROW_TIME_UNIT_MILLI:
-      if (std::strcmp("", schema_view.timezone)) {
-        return std::make_unique<
-            TimestampInsertHelper<NANOARROW_TIME_UNIT_MILLI, true>>(
-            inserter, chunk, child_schema, error, column_position);
-      } else {
-        return std::make_unique<
-            TimestampInsertHelper<NANOARROW_TIME_UNIT_MILLI, false>>(
-            inserter, chunk, child_schema, error, column_position);
-      }
+      return MakeTimestampKernel<NANOARROW_TIME_UNIT_MILLI>(schema, error,
+                                                            tz_aware);
     case NANOARROW_TIME_UNIT_MICRO:
-      if (std::strcmp("", schema_view.timezone)) {
-        return std::make_unique<
-            TimestampInsertHelper<NANOARROW_TIME_UNIT_MICRO, true>>(
-            inserter, chunk, child_schema, error, column_position);
-      } else {
-        return std::make_unique<
-            TimestampInsertHelper<NANOARROW_TIME_UNIT_MICRO, false>>(
-            inserter, chunk, child_schema, error, column_position);
-      }
+      return MakeTimestampKernel<NANOARROW_TIME_UNIT_MICRO>(schema, error,
+                                                            tz_aware);
     case NANOARROW_TIME_UNIT_NANO:
-      if (std::strcmp("", schema_view.timezone)) {
-        return std::make_unique<
-            TimestampInsertHelper<NANOARROW_TIME_UNIT_NANO, true>>(
-            inserter, chunk, child_schema, error, column_position);
-      } else {
-        return std::make_unique<
-            TimestampInsertHelper<NANOARROW_TIME_UNIT_NANO, false>>(
-            inserter, chunk, child_schema, error, column_position);
-      }
+      return MakeTimestampKernel<NANOARROW_TIME_UNIT_NANO>(schema, error,
+                                                           tz_aware);
     }
     throw std::runtime_error(
         "This code block should not be hit - contact a developer");
+  }
   case NANOARROW_TYPE_INTERVAL_MONTH_DAY_NANO:
-    return std::make_unique<IntervalInsertHelper>(inserter, chunk, child_schema,
-                                                  error, column_position);
+    return MakeKernel<IntervalKernel>(schema, error);
   case NANOARROW_TYPE_TIME64:
     switch (schema_view.time_unit) {
-    // must be a smarter way to do this!
     case NANOARROW_TIME_UNIT_SECOND: // untested
-      return std::make_unique<TimeInsertHelper<NANOARROW_TIME_UNIT_SECOND>>(
-          inserter, chunk, child_schema, error, column_position);
+      return MakeKernel<TimeKernel<NANOARROW_TIME_UNIT_SECOND>>(schema, error);
     case NANOARROW_TIME_UNIT_MILLI: // untested
-      return std::make_unique<TimeInsertHelper<NANOARROW_TIME_UNIT_MILLI>>(
-          inserter, chunk, child_schema, error, column_position);
+      return MakeKernel<TimeKernel<NANOARROW_TIME_UNIT_MILLI>>(schema, error);
     case NANOARROW_TIME_UNIT_MICRO:
-      return std::make_unique<TimeInsertHelper<NANOARROW_TIME_UNIT_MICRO>>(
-          inserter, chunk, child_schema, error, column_position);
+      return MakeKernel<TimeKernel<NANOARROW_TIME_UNIT_MICRO>>(schema, error);
     case NANOARROW_TIME_UNIT_NANO:
-      return std::make_unique<TimeInsertHelper<NANOARROW_TIME_UNIT_NANO>>(
-          inserter, chunk, child_schema, error, column_position);
+      return MakeKernel<TimeKernel<NANOARROW_TIME_UNIT_NANO>>(schema, error);
     }
     throw std::runtime_error(
         "This code block should not be hit - contact a developer");
-  case NANOARROW_TYPE_DECIMAL128: {
-    const auto precision = schema_view.decimal_precision;
-    const auto scale = schema_view.decimal_scale;
-    return std::make_unique<DecimalInsertHelper>(inserter, chunk, child_schema,
-                                                 error, column_position,
-                                                 precision, scale);
-  }
+  case NANOARROW_TYPE_DECIMAL128:
+    return MakeKernel<DecimalKernel>(schema, error,
+                                     schema_view.decimal_precision,
+                                     schema_view.decimal_scale);
   case NANOARROW_TYPE_BINARY_VIEW:
-    return std::make_unique<BinaryViewInsertHelper<false>>(
-        inserter, chunk, child_schema, error, column_position);
+    return MakeKernel<BinaryViewKernel<false>>(schema, error);
   case NANOARROW_TYPE_STRING_VIEW:
-    return std::make_unique<BinaryViewInsertHelper<true>>(
-        inserter, chunk, child_schema, error, column_position);
+    return MakeKernel<BinaryViewKernel<true>>(schema, error);
   case NANOARROW_TYPE_DICTIONARY: {
     struct ArrowSchemaView value_view {};
     NANOARROW_THROW_NOT_OK(
-        ArrowSchemaViewInit(&value_view, child_schema->dictionary, error));
+        ArrowSchemaViewInit(&value_view, schema->dictionary, error));
 
-    // only support dictionary-encoded string values for now
     switch (value_view.type) {
     case NANOARROW_TYPE_STRING:
     case NANOARROW_TYPE_LARGE_STRING:
     case NANOARROW_TYPE_STRING_VIEW:
-      return std::make_unique<DictionaryInsertHelper>(
-          inserter, chunk, child_schema, error, column_position);
+      return MakeKernel<DictionaryKernel<hyperapi::string_view>>(schema, error);
+    case NANOARROW_TYPE_BINARY:
+    case NANOARROW_TYPE_LARGE_BINARY:
+    case NANOARROW_TYPE_BINARY_VIEW:
+      return MakeKernel<DictionaryKernel<hyperapi::ByteSpan>>(schema, error);
+    case NANOARROW_TYPE_INT8:
+    case NANOARROW_TYPE_INT16:
+      return MakeKernel<DictionaryKernel<int16_t>>(schema, error);
+    case NANOARROW_TYPE_INT32:
+      return MakeKernel<DictionaryKernel<int32_t>>(schema, error);
+    case NANOARROW_TYPE_INT64:
+      return MakeKernel<DictionaryKernel<int64_t>>(schema, error);
+    case NANOARROW_TYPE_DATE32:
+      return MakeKernel<DictionaryKernel<hyperapi::Date>>(schema, error);
     default:
       throw std::invalid_argument(
-          std::string("MakeInsertHelper: Can only encode dictionaries with "
-                      "binary value types, got:") +
+          std::string("MakeColumnKernel: Can only encode dictionaries with "
+                      "string, binary, integer or date value types, got:") +
           ArrowTypeString(value_view.type));
     }
   }
   default:
     throw std::invalid_argument(
-        std::string("MakeInsertHelper: Unsupported Arrow type: ") +
+        std::string("MakeColumnKernel: Unsupported Arrow type: ") +
         ArrowTypeString(schema_view.type));
   }
 }
 
+///
+/// The insert plan holds one kernel per column of a stream. It is compiled
+/// once from the stream schema and then bound to each chunk in turn, so no
+/// schema parsing happens inside the chunk loop.
+///
+/// With statistics enabled, the plan also counts the rows and nulls it
+/// inserts and has every kernel observe the values it inserts, which costs
+/// a comparison or two per value rather than a scan of the table.
+///
+class InsertPlan {
+public:
+  InsertPlan(const struct ArrowSchema *schema, struct ArrowError *error,
+             bool statistics = false)
+      : statistics_{statistics} {
+    const std::span children{schema->children,
+                             static_cast<size_t>(schema->n_children)};
+    kernels_.reserve(children.size());
+    for (const auto *child : children) {
+      kernels_.emplace_back(MakeColumnKernel(child, error));
+    }
+    validity_words_.resize(kernels_.size());
+    null_counts_.resize(kernels_.size());
+  }
+
+  auto Bind(const struct ArrowArray *chunk, struct ArrowError *error) -> void {
+    if (static_cast<size_t>(chunk->n_children) != kernels_.size()) {
+      throw std::runtime_error(
+          "Number of columns in chunk does not match stream schema");
+    }
+
+    const std::span children{chunk->children,
+                             static_cast<size_t>(chunk->n_children)};
+    for (size_t i = 0; i < kernels_.size(); i++) {
+      std::visit([&](auto &kernel) { kernel.Bind(children[i], error); },
+                 kernels_[i]);
+    }
+  }
+
+  auto InsertRows(hyperapi::Inserter &inserter, int64_t nrows) -> void {
+    if (statistics_) {
+      InsertRowsImpl<false, true>(inserter, nrows, 0);
+    } else {
+      InsertRowsImpl<false, false>(inserter, nrows, 0);
+    }
+  }
+
+  ///
+  /// The size of the Arrow buffers backing the bound chunk
+  ///
+  auto BoundBytes() const -> int64_t {
+    int64_t nbytes = 0;
+    for (const auto &kernel : kernels_) {
+      nbytes +=
+          std::visit([](const auto &k) { return k.BoundBytes(); }, kernel);
+    }
+    return nbytes;
+  }
+
+  ///
+  /// Like InsertRows, but also appends the position of every row within the
+  /// stream as a trailing BIGINT column, starting at first_ordinal
+  ///
+  auto InsertRows(hyperapi::Inserter &inserter, int64_t nrows,
+                  int64_t first_ordinal) -> void {
+    if (statistics_) {
+      InsertRowsImpl<true, true>(inserter, nrows, first_ordinal);
+    } else {
+      InsertRowsImpl<true, false>(inserter, nrows, first_ordinal);
+    }
+  }
+
+  ///
+  /// Inserts an arbitrary selection of the rows of the bound chunk, in the
+  /// order given
+  ///
+  auto InsertRowsAt(hyperapi::Inserter &inserter,
+                    std::span<const int64_t> rows) -> void {
+    for (const auto row_idx : rows) {
+      for (size_t i = 0; i < kernels_.size(); i++) {
+        std::visit(
+            [&](auto &k) {
+              if (k.IsValid(row_idx)) {
+                k.InsertValue(inserter, row_idx);
+                if (statistics_) {
+                  k.Observe(row_idx);
+                }
+              } else {
+                k.InsertNull(inserter);
+                if (statistics_) {
+                  null_counts_[i]++;
+                }
+              }
+            },
+            kernels_[i]);
+      }
+      inserter.endRow();
+    }
+    if (statistics_) {
+      EndChunk(static_cast<int64_t>(rows.size()));
+    }
+  }
+
+  ///
+  /// The statistics of the rows inserted since the last call. Only plans
+  /// built with statistics enabled collect any.
+  ///
+  auto TakeStatistics() -> BatchStatistics {
+    BatchStatistics batch{rows_,
+                          std::vector<ColumnStatistics>(kernels_.size())};
+    for (size_t i = 0; i < kernels_.size(); i++) {
+      batch.columns[i].null_count = null_counts_[i];
+      std::visit([&](auto &k) { k.TakeRange(batch.columns[i]); }, kernels_[i]);
+    }
+    rows_ = 0;
+    std::ranges::fill(null_counts_, 0);
+    return batch;
+  }
+
+private:
+  template <bool WithOrdinal, bool WithStatistics>
+  auto InsertRowsImpl(hyperapi::Inserter &inserter, int64_t nrows,
+                      [[maybe_unused]] int64_t first_ordinal) -> void {
+    const bool has_nulls =
+        std::ranges::any_of(kernels_, [](const auto &kernel) {
+          return std::visit([](const auto &k) { return k.HasNulls(); },
+                            kernel);
+        });
+
+    if (!has_nulls) {
+      for (int64_t row_idx = 0; row_idx < nrows; row_idx++) {
+        for (auto &kernel : kernels_) {
+          std::visit(
+              [&](auto &k) {
+                k.InsertValue(inserter, row_idx);
+                if constexpr (WithStatistics) {
+                  k.Observe(row_idx);
+                }
+              },
+              kernel);
+        }
+        if constexpr (WithOrdinal) {
+          inserter.add(first_ordinal + row_idx);
+        }
+        inserter.endRow();
+      }
+      if constexpr (WithStatistics) {
+        EndChunk(nrows);
+      }
+      return;
+    }
+
+    // Walk the chunk a bitmap word at a time so each column loads its
+    // validity once per 64 rows; rows are then resolved with a shift
+    constexpr auto BitsPerWord = ColumnKernel::BitsPerWord;
+    for (int64_t block_start = 0; block_start < nrows;
+         block_start += BitsPerWord) {
+      const auto block_length = std::min(BitsPerWord, nrows - block_start);
+      for (size_t i = 0; i < kernels_.size(); i++) {
+        validity_words_[i] = std::visit(
+            [&](const auto &k) {
+              return k.ValidityWord(block_start, block_length);
+            },
+            kernels_[i]);
+        if constexpr (WithStatistics) {
+          null_counts_[i] += block_length - std::popcount(validity_words_[i]);
+        }
+      }
+
+      for (int64_t bit = 0; bit < block_length; bit++) {
+        const auto row_idx = block_start + bit;
+        for (size_t i = 0; i < kernels_.size(); i++) {
+          const bool is_valid = ((validity_words_[i] >> bit) & 1U) != 0;
+          std::visit(
+              [&](auto &k) {
+                if (is_valid) {
+                  k.InsertValue(inserter, row_idx);
+                  if constexpr (WithStatistics) {
+                    k.Observe(row_idx);
+                  }
+                } else {
+                  k.InsertNull(inserter);
+                }
+              },
+              kernels_[i]);
+        }
+        if constexpr (WithOrdinal) {
+          inserter.add(first_ordinal + row_idx);
+        }
+        inserter.endRow();
+      }
+    }
+    if constexpr (WithStatistics) {
+      EndChunk(nrows);
+    }
+  }
+
+  ///
+  /// Accounts for the rows inserted from the bound chunk, whose buffers the
+  /// kernel ranges may no longer point into afterwards
+  ///
+  auto EndChunk(int64_t nrows) -> void {
+    rows_ += nrows;
+    for (auto &kernel : kernels_) {
+      std::visit([](auto &k) { k.SettleRange(); }, kernel);
+    }
+  }
+
+  std::vector<ColumnKernelVariant> kernels_;
+  std::vector<uint64_t> validity_words_;
+  bool statistics_;
+  int64_t rows_{};
+  std::vector<int64_t> null_counts_;
+};
+
 static bool IsCompatibleHyperType(const hyperapi::SqlType &new_type,
                                   const hyperapi::SqlType &old_type) {
   if (new_type == old_type) {
@@ -719,82 +1442,214 @@ static void AssertColumnsEqual(
   }
 };
 
-void write_to_hyper(
-    const nb::object &dict_of_capsules, const std::string &path,
-    const std::string &table_mode, const nb::iterable not_null_columns,
-    const nb::iterable json_columns, const nb::iterable geo_columns,
-    std::unordered_map<std::string, std::string> &&process_params) {
-
-  std::set<std::string> not_null_set;
-  for (auto col : not_null_columns) {
-    const auto colstr = nb::cast<std::string>(col);
-    not_null_set.insert(colstr);
+///
+/// Pulls chunks from an Arrow stream on a worker thread, so that fetching and
+/// checking the next chunk overlaps with inserting the current one. At most
+/// queue_depth chunks are buffered ahead of the consumer; a depth of zero
+/// reads chunks synchronously on the calling thread.
+///
+/// Streams may be implemented in Python, so every call into the stream is
+/// made with the GIL held. The thread owning this object must therefore not
+/// hold the GIL while waiting on it.
+///
+class ChunkPrefetcher {
+public:
+  ChunkPrefetcher(struct ArrowArrayStream *stream, int64_t n_columns,
+                  size_t queue_depth)
+      : stream_{stream}, n_columns_{n_columns}, queue_depth_{queue_depth} {
+    if (queue_depth_ > 0) {
+      worker_ = std::thread{[this] { Run(); }};
+    }
   }
 
-  std::set<std::string> json_set;
-  for (auto col : json_columns) {
-    const auto colstr = nb::cast<std::string>(col);
-    json_set.insert(colstr);
-  }
+  ChunkPrefetcher(const ChunkPrefetcher &) = delete;
+  auto operator=(const ChunkPrefetcher &) -> ChunkPrefetcher & = delete;
+  ChunkPrefetcher(ChunkPrefetcher &&) = delete;
+  auto operator=(ChunkPrefetcher &&) -> ChunkPrefetcher & = delete;
 
-  std::set<std::string> geo_set;
-  for (auto col : geo_columns) {
-    const auto colstr = nb::cast<std::string>(col);
-    geo_set.insert(colstr);
+  ~ChunkPrefetcher() {
+    if (worker_.joinable()) {
+      {
+        const std::lock_guard lock{mutex_};
+        stopped_ = true;
+      }
+      space_available_.notify_one();
+      worker_.join();
+    }
   }
 
-  if (!process_params.count("log_config")) {
-    process_params["log_config"] = "";
-  } else {
-    process_params.erase("log_config");
+  ///
+  /// Returns the next chunk of the stream, or std::nullopt once it is
+  /// exhausted. Errors hit by the worker are rethrown here, after any chunks
+  /// read before the error have been consumed.
+  ///
+  auto Next() -> std::optional<nanoarrow::UniqueArray> {
+    if (!worker_.joinable()) {
+      return ReadChunk();
+    }
+
+    std::unique_lock lock{mutex_};
+    chunk_available_.wait(lock,
+                          [this] { return !queue_.empty() || finished_; });
+    if (!queue_.empty()) {
+      auto chunk = std::move(queue_.front());
+      queue_.pop_front();
+      lock.unlock();
+      space_available_.notify_one();
+      return chunk;
+    }
+
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+    return std::nullopt;
   }
-  if (!process_params.count("default_database_version"))
-    process_params["default_database_version"] = "2";
 
-  const hyperapi::HyperProcess hyper{
-      hyperapi::Telemetry::DoNotSendUsageDataToTableau, "",
-      std::move(process_params)};
+private:
+  auto ReadChunk() -> std::optional<nanoarrow::UniqueArray> {
+    nanoarrow::UniqueArray chunk{};
+    {
+      const nb::gil_scoped_acquire gil{};
+      if (stream_->get_next(stream_, chunk.get()) != 0) {
+        const char *last_error = stream_->get_last_error(stream_);
+        throw std::runtime_error(
+            "Could not read from arrow stream: " +
+            std::string{last_error != nullptr ? last_error : ""});
+      }
+    }
 
-  // TODO: we don't have separate table / database create modes in the API
-  // but probably should; for now we infer this from table mode
-  const auto createMode = table_mode == "w"
-                              ? hyperapi::CreateMode::CreateAndReplace
-                              : hyperapi::CreateMode::CreateIfNotExists;
+    if (chunk->release == nullptr) {
+      return std::nullopt;
+    }
+    if (chunk->length < 0) {
+      throw std::runtime_error("Unexpected array length < 0");
+    }
+    if (chunk->n_children != n_columns_) {
+      throw std::runtime_error(
+          "Expected " + std::to_string(n_columns_) +
+          " columns in stream chunk; got " + std::to_string(chunk->n_children));
+    }
 
-  hyperapi::Connection connection{hyper.getEndpoint(), path, createMode};
-  const hyperapi::Catalog &catalog = connection.getCatalog();
+    return chunk;
+  }
 
-  for (auto const &[name, capsule] :
-       nb::cast<nb::dict>(dict_of_capsules, false)) {
-    const auto c_stream = static_cast<struct ArrowArrayStream *>(
-        PyCapsule_GetPointer(capsule.ptr(), "arrow_array_stream"));
-    if (c_stream == nullptr) {
-      throw std::invalid_argument("Invalid PyCapsule provided!");
+  auto Run() -> void {
+    try {
+      while (true) {
+        {
+          std::unique_lock lock{mutex_};
+          space_available_.wait(lock, [this] {
+            return stopped_ || queue_.size() < queue_depth_;
+          });
+          if (stopped_) {
+            break;
+          }
+        }
+
+        auto chunk = ReadChunk();
+        if (!chunk) {
+          break;
+        }
+
+        {
+          const std::lock_guard lock{mutex_};
+          queue_.emplace_back(std::move(*chunk));
+        }
+        chunk_available_.notify_one();
+      }
+    } catch (...) {
+      const std::lock_guard lock{mutex_};
+      error_ = std::current_exception();
     }
-    auto stream = nanoarrow::UniqueArrayStream{c_stream};
 
-    nanoarrow::UniqueSchema schema{};
-    if (stream->get_schema(stream.get(), schema.get()) != 0) {
-      std::string error_msg{stream->get_last_error(stream.get())};
-      throw std::runtime_error("Could not read from arrow schema:" + error_msg);
+    {
+      const std::lock_guard lock{mutex_};
+      finished_ = true;
     }
+    chunk_available_.notify_one();
+  }
 
-    struct ArrowError error {};
-    std::vector<hyperapi::TableDefinition::Column> hyper_columns;
-    std::vector<hyperapi::Inserter::ColumnMapping> column_mappings;
-    // subtley different from hyper_columns with geo
-    std::vector<hyperapi::TableDefinition::Column> inserter_defs;
+  struct ArrowArrayStream *stream_;
+  int64_t n_columns_;
+  size_t queue_depth_;
+
+  std::mutex mutex_;
+  std::condition_variable chunk_available_;
+  std::condition_variable space_available_;
+  std::deque<nanoarrow::UniqueArray> queue_;
+  bool finished_{};
+  bool stopped_{};
+  std::exception_ptr error_;
+  std::thread worker_;
+};
 
-    const std::span children{schema->children,
-                             static_cast<size_t>(schema->n_children)};
-    for (int64_t i = 0; i < schema->n_children; i++) {
-      const std::string col_name{children[i]->name};
-      const auto nullability = not_null_set.find(col_name) != not_null_set.end()
-                                   ? hyperapi::Nullability::NotNullable
-                                   : hyperapi::Nullability::Nullable;
-
-      if (json_set.find(col_name) != json_set.end()) {
-        const auto hypertype = hyperapi::SqlType::json();
+///
+/// Column level options shared by every table in a write
+///
+struct ColumnOptions {
+  std::set<std::string> not_null;
+  std::set<std::string> json;
+  std::set<std::string> geo;
+};
+
+///
+/// The columns of the target table, along with how the inserter maps onto
+/// them
+///
+struct TableColumns {
+  std::vector<hyperapi::TableDefinition::Column> hyper_columns;
+  std::vector<hyperapi::Inserter::ColumnMapping> column_mappings;
+  // subtley different from hyper_columns with geo
+  std::vector<hyperapi::TableDefinition::Column> inserter_defs;
+};
+
+static auto MakeTableColumns(const struct ArrowSchema *schema,
+                             const ColumnOptions &options,
+                             struct ArrowError *error) -> TableColumns {
+  TableColumns columns;
+  auto &hyper_columns = columns.hyper_columns;
+  auto &column_mappings = columns.column_mappings;
+  auto &inserter_defs = columns.inserter_defs;
+
+  const std::span children{schema->children,
+                           static_cast<size_t>(schema->n_children)};
+  for (int64_t i = 0; i < schema->n_children; i++) {
+    const std::string col_name{children[i]->name};
+    const auto nullability = options.not_null.contains(col_name)
+                                 ? hyperapi::Nullability::NotNullable
+                                 : hyperapi::Nullability::Nullable;
+
+    if (options.json.contains(col_name)) {
+      const auto hypertype = hyperapi::SqlType::json();
+      const hyperapi::TableDefinition::Column column{col_name, hypertype,
+                                                     nullability};
+
+      hyper_columns.emplace_back(column);
+      inserter_defs.emplace_back(std::move(column));
+      const hyperapi::Inserter::ColumnMapping mapping{col_name};
+      column_mappings.emplace_back(mapping);
+    } else if (options.geo.contains(col_name)) {
+      // if binary just write as is; for text we provide conversion
+      const auto detected_type =
+          GetHyperTypeFromArrowSchema(children[i], error);
+      if (detected_type == hyperapi::SqlType::text()) {
+        const auto hypertype = hyperapi::SqlType::geography();
+        const hyperapi::TableDefinition::Column column{col_name, hypertype,
+                                                       nullability};
+
+        hyper_columns.emplace_back(std::move(column));
+        const auto insertertype = hyperapi::SqlType::text();
+        const auto as_text_name = col_name + "_as_text";
+        const hyperapi::TableDefinition::Column inserter_column{
+            as_text_name, insertertype, nullability};
+        inserter_defs.emplace_back(std::move(inserter_column));
+
+        const auto escaped = hyperapi::escapeName(as_text_name);
+        const hyperapi::Inserter::ColumnMapping mapping{
+            col_name, "CAST(" + escaped + " AS GEOGRAPHY)"};
+        column_mappings.emplace_back(mapping);
+      } else if (detected_type == hyperapi::SqlType::bytes()) {
+        const auto hypertype = hyperapi::SqlType::geography();
         const hyperapi::TableDefinition::Column column{col_name, hypertype,
                                                        nullability};
 
@@ -802,126 +1657,2204 @@ void write_to_hyper(
         inserter_defs.emplace_back(std::move(column));
         const hyperapi::Inserter::ColumnMapping mapping{col_name};
         column_mappings.emplace_back(mapping);
-      } else if (geo_set.find(col_name) != geo_set.end()) {
-        // if binary just write as is; for text we provide conversion
-        const auto detected_type =
-            GetHyperTypeFromArrowSchema(children[i], &error);
-        if (detected_type == hyperapi::SqlType::text()) {
-          const auto hypertype = hyperapi::SqlType::geography();
-          const hyperapi::TableDefinition::Column column{col_name, hypertype,
-                                                         nullability};
-
-          hyper_columns.emplace_back(std::move(column));
-          const auto insertertype = hyperapi::SqlType::text();
-          const auto as_text_name = col_name + "_as_text";
-          const hyperapi::TableDefinition::Column inserter_column{
-              as_text_name, insertertype, nullability};
-          inserter_defs.emplace_back(std::move(inserter_column));
-
-          const auto escaped = hyperapi::escapeName(as_text_name);
-          const hyperapi::Inserter::ColumnMapping mapping{
-              col_name, "CAST(" + escaped + " AS GEOGRAPHY)"};
-          column_mappings.emplace_back(mapping);
-        } else if (detected_type == hyperapi::SqlType::bytes()) {
-          const auto hypertype = hyperapi::SqlType::geography();
-          const hyperapi::TableDefinition::Column column{col_name, hypertype,
-                                                         nullability};
-
-          hyper_columns.emplace_back(column);
-          inserter_defs.emplace_back(std::move(column));
-          const hyperapi::Inserter::ColumnMapping mapping{col_name};
-          column_mappings.emplace_back(mapping);
-        } else {
-          throw std::runtime_error(
-              "Unexpected code path hit - contact a developer");
-        }
       } else {
-        struct ArrowSchemaView schema_view {};
-        if (ArrowSchemaViewInit(&schema_view, children[i], &error)) {
-          throw std::runtime_error(
-              "Could not init schema view from child schema " +
-              std::to_string(i) + ": " + std::string(&error.message[0]));
-        }
+        throw std::runtime_error(
+            "Unexpected code path hit - contact a developer");
+      }
+    } else {
+      struct ArrowSchemaView schema_view {};
+      if (ArrowSchemaViewInit(&schema_view, children[i], error)) {
+        throw std::runtime_error(
+            "Could not init schema view from child schema " +
+            std::to_string(i) + ": " + std::string(&error->message[0]));
+      }
 
-        if (schema_view.type == NANOARROW_TYPE_DECIMAL128) {
-          const auto precision = schema_view.decimal_precision;
-          const auto scale = schema_view.decimal_scale;
-          const auto hypertype = hyperapi::SqlType::numeric(precision, scale);
-          const hyperapi::TableDefinition::Column column{col_name, hypertype,
-                                                         nullability};
-
-          hyper_columns.emplace_back(column);
-          inserter_defs.emplace_back(std::move(column));
-          const hyperapi::Inserter::ColumnMapping mapping{col_name};
-          column_mappings.emplace_back(mapping);
-        } else {
-          const auto hypertype =
-              GetHyperTypeFromArrowSchema(children[i], &error);
-          const hyperapi::TableDefinition::Column column{col_name, hypertype,
-                                                         nullability};
-
-          hyper_columns.emplace_back(column);
-          inserter_defs.emplace_back(std::move(column));
-          const hyperapi::Inserter::ColumnMapping mapping{col_name};
-          column_mappings.emplace_back(mapping);
-        }
+      if (schema_view.type == NANOARROW_TYPE_DECIMAL128) {
+        const auto precision = schema_view.decimal_precision;
+        const auto scale = schema_view.decimal_scale;
+        const auto hypertype = hyperapi::SqlType::numeric(precision, scale);
+        const hyperapi::TableDefinition::Column column{col_name, hypertype,
+                                                       nullability};
+
+        hyper_columns.emplace_back(column);
+        inserter_defs.emplace_back(std::move(column));
+        const hyperapi::Inserter::ColumnMapping mapping{col_name};
+        column_mappings.emplace_back(mapping);
+      } else {
+        const auto hypertype = GetHyperTypeFromArrowSchema(children[i], error);
+        const hyperapi::TableDefinition::Column column{col_name, hypertype,
+                                                       nullability};
+
+        hyper_columns.emplace_back(column);
+        inserter_defs.emplace_back(std::move(column));
+        const hyperapi::Inserter::ColumnMapping mapping{col_name};
+        column_mappings.emplace_back(mapping);
       }
     }
+  }
+
+  return columns;
+}
+
+///
+/// A table to be written, with everything that requires the GIL already
+/// pulled out of Python
+///
+struct TableStream {
+  hyperapi::TableName table_name;
+  nanoarrow::UniqueArrayStream stream;
+  nanoarrow::UniqueSchema schema;
+};
+
+static auto ToStringSet(const nb::iterable &iterable) -> std::set<std::string> {
+  std::set<std::string> result;
+  for (auto item : iterable) {
+    result.insert(nb::cast<std::string>(item));
+  }
+  return result;
+}
+
+static auto ToTableName(const nb::handle &name) -> hyperapi::TableName {
+  std::tuple<std::string, std::string> schema_and_table;
+  std::string t_name;
+  const auto is_tup = nb::try_cast(name, schema_and_table, false);
+  const auto is_str = nb::try_cast(name, t_name, false);
+  if (!(is_tup || is_str)) {
+    throw nb::type_error("Expected string or tuple key");
+  }
+  return is_tup ? hyperapi::TableName(std::get<0>(schema_and_table),
+                                      std::get<1>(schema_and_table))
+                : hyperapi::TableName(t_name);
+}
+
+///
+/// Takes ownership of the stream held by an "arrow_array_stream" capsule and
+/// reads its schema
+///
+static auto ImportArrayStream(const nb::handle &capsule)
+    -> std::pair<nanoarrow::UniqueArrayStream, nanoarrow::UniqueSchema> {
+  const auto c_stream = static_cast<struct ArrowArrayStream *>(
+      PyCapsule_GetPointer(capsule.ptr(), "arrow_array_stream"));
+  if (c_stream == nullptr) {
+    throw std::invalid_argument("Invalid PyCapsule provided!");
+  }
+  nanoarrow::UniqueArrayStream stream{c_stream};
+  nanoarrow::UniqueSchema schema{};
 
-    std::tuple<std::string, std::string> schema_and_table;
-    std::string t_name;
-    const auto is_tup = nb::try_cast(name, schema_and_table, false);
-    const auto is_str = nb::try_cast(name, t_name, false);
-    if (!(is_tup || is_str)) {
-      throw nb::type_error("Expected string or tuple key");
+  if (stream->get_schema(stream.get(), schema.get()) != 0) {
+    std::string error_msg{stream->get_last_error(stream.get())};
+    throw std::runtime_error("Could not read from arrow schema:" + error_msg);
+  }
+
+  return {std::move(stream), std::move(schema)};
+}
+
+static auto MakeTableStream(const nb::handle &name, const nb::handle &capsule)
+    -> TableStream {
+  auto [stream, schema] = ImportArrayStream(capsule);
+  return {ToTableName(name), std::move(stream), std::move(schema)};
+}
+
+///
+/// The definition of a table ready to receive rows
+///
+struct PreparedTable {
+  hyperapi::TableDefinition definition;
+  TableColumns columns;
+  bool exists;
+};
+
+///
+/// Builds the definition of the target table, validating it against the
+/// existing table if there is one. Nothing is created until CreateTables.
+///
+static auto MakePreparedTable(const hyperapi::Catalog &catalog,
+                              const hyperapi::TableName &table_name,
+                              TableColumns &&columns, bool exists)
+    -> PreparedTable {
+  hyperapi::TableDefinition table_def{table_name, columns.hyper_columns};
+  if (exists) {
+    const auto existing_def = catalog.getTableDefinition(table_name);
+    AssertColumnsEqual(columns.hyper_columns,
+                       std::move(existing_def.getColumns()));
+  }
+
+  return {std::move(table_def), std::move(columns), exists};
+}
+
+static auto PrepareTable(hyperapi::Connection &connection,
+                         const hyperapi::TableName &table_name,
+                         TableColumns &&columns,
+                         const std::string &table_mode) -> PreparedTable {
+  const hyperapi::Catalog &catalog = connection.getCatalog();
+  const bool exists = (table_mode != "w") && catalog.hasTable(table_name);
+  return MakePreparedTable(catalog, table_name, std::move(columns), exists);
+}
+
+///
+/// Unescaped schema and table name, with unqualified names resolving to the
+/// public schema
+///
+using TableKey = std::pair<std::string, std::string>;
+
+static auto MakeTableKey(const hyperapi::TableName &table_name) -> TableKey {
+  const auto &schema_name = table_name.getSchemaName();
+  return {schema_name ? schema_name->getName().getUnescaped() : "public",
+          table_name.getName().getUnescaped()};
+}
+
+///
+/// Prepares every table of a write. Rather than asking the catalog about each
+/// table in turn, the existing tables are listed once per distinct schema, so
+/// that writing thousands of small tables costs a handful of catalog queries.
+///
+template <typename TableT>
+static auto PrepareAllTables(hyperapi::Connection &connection,
+                             const std::vector<TableT> &tables,
+                             std::vector<TableColumns> &&columns,
+                             const std::string &table_mode)
+    -> std::vector<PreparedTable> {
+  const hyperapi::Catalog &catalog = connection.getCatalog();
+
+  std::set<TableKey> existing;
+  if (table_mode != "w") {
+    std::set<std::string> schemas;
+    for (const auto &table : tables) {
+      schemas.insert(MakeTableKey(table.table_name).first);
     }
-    const auto table_name =
-        is_tup ? hyperapi::TableName(std::get<0>(schema_and_table),
-                                     std::get<1>(schema_and_table))
-               : hyperapi::TableName(t_name);
-    const hyperapi::TableDefinition table_def{table_name, hyper_columns};
-
-    const auto schema_name =
-        table_name.getSchemaName() ? *table_name.getSchemaName() : "public";
-    catalog.createSchemaIfNotExists(schema_name);
-
-    if ((table_mode == "a") && (catalog.hasTable(table_name))) {
-      const auto existing_def = catalog.getTableDefinition(table_name);
-      AssertColumnsEqual(hyper_columns, std::move(existing_def.getColumns()));
-    } else {
-      catalog.createTable(table_def);
-    }
-    auto inserter = hyperapi::Inserter(connection, table_def, column_mappings,
-                                       inserter_defs);
-
-    struct ArrowArray c_chunk {};
-    int errcode{};
-    while ((errcode = stream->get_next(stream.get(), &c_chunk) == 0) &&
-           c_chunk.release != nullptr) {
-      nanoarrow::UniqueArray chunk{&c_chunk};
-      const auto nrows = chunk->length;
-      if (nrows < 0) {
-        throw std::runtime_error("Unexpected array length < 0");
+    for (const auto &schema_name : catalog.getSchemaNames()) {
+      if (!schemas.contains(schema_name.getName().getUnescaped())) {
+        continue;
       }
+      for (const auto &table_name : catalog.getTableNames(schema_name)) {
+        existing.insert(MakeTableKey(table_name));
+      }
+    }
+  }
 
-      std::vector<std::unique_ptr<InsertHelper>> insert_helpers;
-      for (int64_t i = 0; i < schema->n_children; i++) {
-        // the lifetime of the inserthelper cannot exceed that of chunk or
-        // schema this is implicit; we should make this explicit
-        auto insert_helper =
-            MakeInsertHelper(inserter, chunk.get(), schema.get(), &error, i);
+  std::vector<PreparedTable> prepared;
+  prepared.reserve(tables.size());
+  for (size_t i = 0; i < tables.size(); i++) {
+    const auto &table_name = tables[i].table_name;
+    const bool exists = existing.contains(MakeTableKey(table_name));
+    prepared.emplace_back(MakePreparedTable(catalog, table_name,
+                                            std::move(columns[i]), exists));
+  }
+  return prepared;
+}
 
-        insert_helpers.push_back(std::move(insert_helper));
-      }
+///
+/// Resolves the columns of every table ahead of opening the database, so that
+/// an unsupported schema fails without touching the file
+///
+template <typename TableT>
+static auto MakeAllTableColumns(const std::vector<TableT> &tables,
+                                const ColumnOptions &options)
+    -> std::vector<TableColumns> {
+  struct ArrowError error {};
+  std::vector<TableColumns> columns;
+  columns.reserve(tables.size());
+  for (const auto &table : tables) {
+    columns.emplace_back(MakeTableColumns(table.schema.get(), options, &error));
+  }
+  return columns;
+}
 
-      for (int64_t row_idx = 0; row_idx < nrows; row_idx++) {
-        for (const auto &insert_helper : insert_helpers) {
-          insert_helper->InsertValueAtIndex(row_idx);
-        }
-        inserter.endRow();
-      }
+///
+/// Creates the prepared tables that do not exist yet, along with their
+/// schemas. Each distinct schema is only created once.
+///
+static auto CreateTables(hyperapi::Connection &connection,
+                         std::span<const PreparedTable> prepared) -> void {
+  const hyperapi::Catalog &catalog = connection.getCatalog();
+  std::set<std::string> schemas;
+  for (const auto &table : prepared) {
+    if (table.exists) {
+      continue;
+    }
+
+    const auto &table_name = table.definition.getTableName();
+    if (schemas.insert(MakeTableKey(table_name).first).second) {
+      const auto schema_name = table_name.getSchemaName()
+                                   ? *table_name.getSchemaName()
+                                   : "public";
+      catalog.createSchemaIfNotExists(schema_name);
+    }
+    catalog.createTable(table.definition);
+  }
+}
+
+///
+/// SQL spelling of a Hyper type, for use in CAST expressions
+///
+static auto GetSqlTypeName(const hyperapi::SqlType &sqltype) -> std::string {
+  switch (sqltype.getTag()) {
+  case hyperapi::TypeTag::SmallInt:
+    return "SMALLINT";
+  case hyperapi::TypeTag::Int:
+    return "INTEGER";
+  case hyperapi::TypeTag::BigInt:
+    return "BIGINT";
+  case hyperapi::TypeTag::Oid:
+    return "OID";
+  case hyperapi::TypeTag::Float:
+    return "REAL";
+  case hyperapi::TypeTag::Double:
+    return "DOUBLE PRECISION";
+  case hyperapi::TypeTag::Bool:
+    return "BOOLEAN";
+  case hyperapi::TypeTag::Bytes:
+    return "BYTEA";
+  case hyperapi::TypeTag::Text:
+    return "TEXT";
+  case hyperapi::TypeTag::Json:
+    return "JSON";
+  case hyperapi::TypeTag::Geography:
+    return "GEOGRAPHY";
+  case hyperapi::TypeTag::Date:
+    return "DATE";
+  case hyperapi::TypeTag::Time:
+    return "TIME";
+  case hyperapi::TypeTag::Timestamp:
+    return "TIMESTAMP";
+  case hyperapi::TypeTag::TimestampTZ:
+    return "TIMESTAMP WITH TIME ZONE";
+  case hyperapi::TypeTag::Interval:
+    return "INTERVAL";
+  case hyperapi::TypeTag::Numeric:
+    return "NUMERIC(" + std::to_string(sqltype.getPrecision()) + ", " +
+           std::to_string(sqltype.getScale()) + ")";
+  default:
+    throw std::invalid_argument("Cannot bulk load Hyper type: " +
+                                sqltype.toString());
+  }
+}
+
+// per-column statistics of the tables written with statistics enabled,
+// describing each table as a whole
+static const hyperapi::TableName StatisticsTableName{
+    hyperapi::SchemaName{"public"}, "__pantab_statistics"};
+
+// the same statistics for each batch of rows appended to such a table,
+// numbered from first_row in the order the batches were written
+static const hyperapi::TableName RangeStatisticsTableName{
+    hyperapi::SchemaName{"public"}, "__pantab_statistics_ranges"};
+
+///
+/// How a write maintains the recorded statistics of its tables. Writes
+/// without statistics drop any recorded ones, which would no longer hold.
+///
+enum class StatisticsMode { None, Collect, Rescan };
+
+static auto ToStatisticsMode(const std::string &statistics) -> StatisticsMode {
+  if (statistics == "none") {
+    return StatisticsMode::None;
+  }
+  if (statistics == "collect") {
+    return StatisticsMode::Collect;
+  }
+  if (statistics == "rescan") {
+    return StatisticsMode::Rescan;
+  }
+  throw std::invalid_argument("Unknown statistics mode: " + statistics);
+}
+
+static auto CreateStatisticsTables(hyperapi::Connection &connection) -> void {
+  const auto not_null = hyperapi::Nullability::NotNullable;
+  const hyperapi::TableDefinition table_def{
+      StatisticsTableName,
+      {{"schema_name", hyperapi::SqlType::text(), not_null},
+       {"table_name", hyperapi::SqlType::text(), not_null},
+       {"column_name", hyperapi::SqlType::text(), not_null},
+       {"column_position", hyperapi::SqlType::integer(), not_null},
+       {"row_count", hyperapi::SqlType::bigInt(), not_null},
+       {"null_count", hyperapi::SqlType::bigInt(), not_null},
+       {"distinct_count", hyperapi::SqlType::bigInt()},
+       {"min_value", hyperapi::SqlType::text()},
+       {"max_value", hyperapi::SqlType::text()}}};
+  const hyperapi::TableDefinition range_def{
+      RangeStatisticsTableName,
+      {{"schema_name", hyperapi::SqlType::text(), not_null},
+       {"table_name", hyperapi::SqlType::text(), not_null},
+       {"column_name", hyperapi::SqlType::text(), not_null},
+       {"column_position", hyperapi::SqlType::integer(), not_null},
+       {"first_row", hyperapi::SqlType::bigInt(), not_null},
+       {"row_count", hyperapi::SqlType::bigInt(), not_null},
+       {"null_count", hyperapi::SqlType::bigInt(), not_null},
+       {"min_value", hyperapi::SqlType::text()},
+       {"max_value", hyperapi::SqlType::text()}}};
+  const auto &catalog = connection.getCatalog();
+  catalog.createTableIfNotExists(table_def);
+  catalog.createTableIfNotExists(range_def);
+}
+
+///
+/// Whether values of a type can be ordered and hashed, which min/max and
+/// distinct counts require
+///
+static auto HasStatistics(const hyperapi::SqlType &sqltype) -> bool {
+  switch (sqltype.getTag()) {
+  case hyperapi::TypeTag::SmallInt:
+  case hyperapi::TypeTag::Int:
+  case hyperapi::TypeTag::BigInt:
+  case hyperapi::TypeTag::Oid:
+  case hyperapi::TypeTag::Float:
+  case hyperapi::TypeTag::Double:
+  case hyperapi::TypeTag::Numeric:
+  case hyperapi::TypeTag::Text:
+  case hyperapi::TypeTag::Varchar:
+  case hyperapi::TypeTag::Char:
+  case hyperapi::TypeTag::Date:
+  case hyperapi::TypeTag::Time:
+  case hyperapi::TypeTag::Timestamp:
+  case hyperapi::TypeTag::TimestampTZ:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static auto StatisticsCondition(const TableKey &key) -> std::string {
+  return "schema_name = " + hyperapi::escapeStringLiteral(key.first) +
+         " AND table_name = " + hyperapi::escapeStringLiteral(key.second);
+}
+
+///
+/// The statistics recorded for a table, if there are any
+///
+static auto ReadStatistics(hyperapi::Connection &connection,
+                           const TableKey &key)
+    -> std::optional<BatchStatistics> {
+  auto result = connection.executeQuery(
+      "SELECT row_count, null_count, distinct_count, min_value, max_value "
+      "FROM " +
+      StatisticsTableName.toString() + " WHERE " + StatisticsCondition(key) +
+      " ORDER BY column_position");
+
+  std::optional<BatchStatistics> recorded;
+  for (const hyperapi::Row &row : result) {
+    if (!recorded) {
+      recorded.emplace(BatchStatistics{row.get<int64_t>(0), {}});
+    }
+    recorded->columns.push_back(
+        {row.get<int64_t>(1), row.get<hyperapi::optional<int64_t>>(2),
+         row.get<hyperapi::optional<std::string>>(3),
+         row.get<hyperapi::optional<std::string>>(4)});
+  }
+  return recorded;
+}
+
+static auto DeleteStatistics(hyperapi::Connection &connection,
+                             const TableKey &key, bool ranges) -> void {
+  connection.executeCommand("DELETE FROM " + StatisticsTableName.toString() +
+                            " WHERE " + StatisticsCondition(key));
+  if (ranges) {
+    connection.executeCommand("DELETE FROM " +
+                              RangeStatisticsTableName.toString() + " WHERE " +
+                              StatisticsCondition(key));
+  }
+}
+
+///
+/// Checks up front that the statistics of every table can be maintained,
+/// and drops those which a write will invalidate. A table with rows but no
+/// recorded statistics has nothing to fold new batches into, so collecting
+/// statistics for it requires a rescan. Must run in the transaction of the
+/// write, if there is one.
+///
+static auto PrepareStatistics(hyperapi::Connection &connection,
+                              std::span<const PreparedTable> prepared,
+                              StatisticsMode mode) -> void {
+  const auto &catalog = connection.getCatalog();
+  if (mode == StatisticsMode::Collect) {
+    CreateStatisticsTables(connection);
+  } else if (!catalog.hasTable(StatisticsTableName)) {
+    return;
+  }
+
+  for (const auto &table : prepared) {
+    const auto &table_name = table.definition.getTableName();
+    const auto key = MakeTableKey(table_name);
+    // statistics of a table which did not exist before are left over from
+    // an earlier table of the same name
+    if (mode != StatisticsMode::Collect || !table.exists) {
+      DeleteStatistics(connection, key, true);
+      continue;
     }
 
-    inserter.execute();
+    const auto recorded = connection.executeScalarQuery<int64_t>(
+        "SELECT COUNT(*) FROM " + StatisticsTableName.toString() + " WHERE " +
+        StatisticsCondition(key));
+    const auto has_rows = connection.executeScalarQuery<int64_t>(
+        "SELECT COUNT(*) FROM (SELECT 1 FROM " + table_name.toString() +
+        " LIMIT 1) AS sample");
+    if (recorded == 0 && has_rows != 0) {
+      throw std::invalid_argument(
+          "Table " + table_name.toString() +
+          " has rows but no recorded statistics to add to; write it with "
+          "statistics='rescan' to aggregate them over the whole table");
+    }
   }
 }
+
+///
+/// What an aggregate over a table collects besides row and null counts
+///
+enum class StatisticsAggregates { Counts, Ranges, Everything };
+
+///
+/// Aggregates the statistics of every column of source, a table or a
+/// parenthesized query, in a single scan
+///
+using TableColumnList = std::vector<hyperapi::TableDefinition::Column>;
+
+static auto AggregateStatistics(hyperapi::Connection &connection,
+                                const TableColumnList &columns,
+                                const std::string &source,
+                                StatisticsAggregates aggregates)
+    -> BatchStatistics {
+  // every column contributes the same four fields to the result row
+  static constexpr hyper_field_index_t FieldsPerColumn = 4;
+
+  std::string select_list = "COUNT(*)";
+  for (const auto &column : columns) {
+    const auto name = column.getName().toString();
+    select_list += ", COUNT(*) - COUNT(" + name + ")";
+    if (aggregates == StatisticsAggregates::Counts ||
+        !HasStatistics(column.getType())) {
+      select_list += ", CAST(NULL AS BIGINT), CAST(NULL AS TEXT), "
+                     "CAST(NULL AS TEXT)";
+      continue;
+    }
+    select_list += aggregates == StatisticsAggregates::Everything
+                       ? ", APPROX_COUNT_DISTINCT(" + name + ")"
+                       : std::string{", CAST(NULL AS BIGINT)"};
+    select_list += ", CAST(MIN(" + name + ") AS TEXT), CAST(MAX(" + name +
+                   ") AS TEXT)";
+  }
+
+  auto result = connection.executeQuery("SELECT " + select_list + " FROM " +
+                                        source + " AS source");
+  BatchStatistics batch;
+  for (const hyperapi::Row &row : result) {
+    batch.row_count = row.get<int64_t>(0);
+    for (size_t i = 0; i < columns.size(); i++) {
+      const auto field = static_cast<hyper_field_index_t>(i) * FieldsPerColumn;
+      batch.columns.push_back(
+          {row.get<int64_t>(field + 1),
+           row.get<hyperapi::optional<int64_t>>(field + 2),
+           row.get<hyperapi::optional<std::string>>(field + 3),
+           row.get<hyperapi::optional<std::string>>(field + 4)});
+    }
+  }
+  return batch;
+}
+
+///
+/// A SQL expression combining rendered values of a type with LEAST or
+/// GREATEST, rendered as text again. Hyper does the comparison, so values
+/// order as they do in the table.
+///
+static auto CombineValues(const std::vector<std::string> &values,
+                          const std::string &sql_type,
+                          std::string_view function) -> std::string {
+  if (values.empty()) {
+    return "CAST(NULL AS TEXT)";
+  }
+
+  std::string arguments;
+  for (const auto &value : values) {
+    if (!arguments.empty()) {
+      arguments += ", ";
+    }
+    arguments += "CAST(" + hyperapi::escapeStringLiteral(value) + " AS " +
+                 sql_type + ")";
+  }
+  return "CAST(" + std::string{function} + "(" + arguments + ") AS TEXT)";
+}
+
+static auto AppendValue(std::vector<std::string> &values,
+                        const std::optional<std::string> &value) -> void {
+  if (value) {
+    values.emplace_back(*value);
+  }
+}
+
+///
+/// Folds the statistics of the batches of rows a write inserted into the
+/// recorded statistics of a table: counts are added up and Hyper combines
+/// the minimum and maximum values, so the table itself is never read. The
+/// batches are also recorded as one row range following the rows recorded
+/// before. Distinct counts cannot be combined and are dropped.
+///
+/// A merge deletes rows first, whose counts are passed as removed. Minimum
+/// and maximum values then remain bounds that the remaining rows may no
+/// longer reach. As the deleted rows leave gaps in the recorded ranges,
+/// they are replaced by a single range covering the whole table, as they
+/// are when a table has no statistics to fold into.
+///
+static auto RecordStatistics(hyperapi::Connection &connection,
+                             const hyperapi::TableDefinition &table_def,
+                             std::span<const BatchStatistics> batches,
+                             const std::optional<BatchStatistics> &removed)
+    -> void {
+  const auto key = MakeTableKey(table_def.getTableName());
+  const auto recorded = ReadStatistics(connection, key);
+  const bool restart_ranges = !recorded || removed;
+  DeleteStatistics(connection, key, restart_ranges);
+
+  const auto &columns = table_def.getColumns();
+  int64_t batch_rows = 0;
+  for (const auto &batch : batches) {
+    batch_rows += batch.row_count;
+  }
+  const int64_t first_row = recorded ? recorded->row_count : 0;
+  const int64_t row_count =
+      first_row + batch_rows - (removed ? removed->row_count : 0);
+  // a table without prior statistics is described by its only batch, which
+  // is an aggregate over the whole table when rescanning
+  const bool keep_distinct = !recorded && !removed && batches.size() == 1;
+
+  const auto table_literal =
+      hyperapi::escapeStringLiteral(key.first) + ", " +
+      hyperapi::escapeStringLiteral(key.second);
+  std::string table_rows;
+  std::string range_rows;
+  for (size_t i = 0; i < columns.size(); i++) {
+    const auto sql_type = HasStatistics(columns[i].getType())
+                              ? GetSqlTypeName(columns[i].getType())
+                              : std::string{};
+    int64_t batch_nulls = 0;
+    std::vector<std::string> batch_mins;
+    std::vector<std::string> batch_maxes;
+    for (const auto &batch : batches) {
+      const auto &stats = batch.columns[i];
+      batch_nulls += stats.null_count;
+      if (!sql_type.empty()) {
+        AppendValue(batch_mins, stats.min_value);
+        AppendValue(batch_maxes, stats.max_value);
+      }
+    }
+
+    auto table_mins = batch_mins;
+    auto table_maxes = batch_maxes;
+    int64_t null_count = batch_nulls;
+    if (recorded && i < recorded->columns.size()) {
+      const auto &stats = recorded->columns[i];
+      null_count += stats.null_count;
+      if (!sql_type.empty()) {
+        AppendValue(table_mins, stats.min_value);
+        AppendValue(table_maxes, stats.max_value);
+      }
+    }
+    if (removed) {
+      null_count -= removed->columns[i].null_count;
+    }
+    const auto &distinct = batches.front().columns[i].distinct_count;
+
+    const auto column_literal =
+        table_literal + ", " +
+        hyperapi::escapeStringLiteral(columns[i].getName().getUnescaped()) +
+        ", " + std::to_string(i);
+    if (!table_rows.empty()) {
+      table_rows += ", ";
+      range_rows += ", ";
+    }
+    table_rows +=
+        "(" + column_literal + ", " + std::to_string(row_count) + ", " +
+        std::to_string(null_count) + ", " +
+        (keep_distinct && distinct ? std::to_string(*distinct)
+                                   : std::string{"CAST(NULL AS BIGINT)"}) +
+        ", " + CombineValues(table_mins, sql_type, "LEAST") + ", " +
+        CombineValues(table_maxes, sql_type, "GREATEST") + ")";
+    range_rows += "(" + column_literal + ", " + std::to_string(first_row) +
+                  ", " + std::to_string(batch_rows) + ", " +
+                  std::to_string(batch_nulls) + ", " +
+                  CombineValues(batch_mins, sql_type, "LEAST") + ", " +
+                  CombineValues(batch_maxes, sql_type, "GREATEST") + ")";
+  }
+  if (columns.empty()) {
+    return;
+  }
+
+  connection.executeCommand("INSERT INTO " + StatisticsTableName.toString() +
+                            " VALUES " + table_rows);
+  if (restart_ranges) {
+    connection.executeCommand(
+        "INSERT INTO " + RangeStatisticsTableName.toString() +
+        " SELECT schema_name, table_name, column_name, column_position, 0, "
+        "row_count, null_count, min_value, max_value FROM " +
+        StatisticsTableName.toString() + " WHERE " + StatisticsCondition(key) +
+        " AND row_count > 0");
+  } else if (batch_rows > 0) {
+    connection.executeCommand("INSERT INTO " +
+                              RangeStatisticsTableName.toString() +
+                              " VALUES " + range_rows);
+  }
+}
+
+///
+/// Replaces the recorded statistics of each table with ones aggregated over
+/// its whole contents, along with a single range covering it. Every column
+/// of a table is aggregated in the same SELECT, but that is still a full
+/// scan of each table on every write.
+///
+static auto RescanStatistics(hyperapi::Connection &connection,
+                             std::span<const PreparedTable> prepared)
+    -> void {
+  CreateStatisticsTables(connection);
+  for (const auto &table : prepared) {
+    const auto &table_def = table.definition;
+    const auto &table_name = table_def.getTableName();
+    DeleteStatistics(connection, MakeTableKey(table_name), true);
+    const std::array batches{
+        AggregateStatistics(connection, table_def.getColumns(),
+                            table_name.toString(),
+                            StatisticsAggregates::Everything)};
+    RecordStatistics(connection, table_def, batches, std::nullopt);
+  }
+}
+
+///
+/// Runs the statements issued on a connection during its lifetime as a
+/// single transaction, which is rolled back unless committed
+///
+class Transaction {
+public:
+  explicit Transaction(hyperapi::Connection &connection)
+      : connection_{&connection} {
+    connection_->executeCommand("BEGIN TRANSACTION");
+  }
+  Transaction(const Transaction &) = delete;
+  auto operator=(const Transaction &) -> Transaction & = delete;
+  Transaction(Transaction &&) = delete;
+  auto operator=(Transaction &&) -> Transaction & = delete;
+
+  ~Transaction() {
+    if (committed_) {
+      return;
+    }
+    try {
+      connection_->executeCommand("ROLLBACK");
+    } catch (...) {
+      // the transaction dies with the connection regardless
+    }
+  }
+
+  auto Commit() -> void {
+    connection_->executeCommand("COMMIT");
+    committed_ = true;
+  }
+
+private:
+  hyperapi::Connection *connection_;
+  bool committed_{false};
+};
+
+///
+/// Streams every chunk into an existing table, returning the statistics of
+/// the inserted rows if asked to collect them. Must be called without the
+/// GIL held.
+///
+static auto InsertStream(hyperapi::Connection &connection,
+                         const hyperapi::TableDefinition &table_def,
+                         const TableColumns &columns,
+                         const struct ArrowSchema *schema,
+                         struct ArrowArrayStream *stream, size_t queue_depth,
+                         bool statistics) -> BatchStatistics {
+  struct ArrowError error {};
+  auto inserter = hyperapi::Inserter(connection, table_def,
+                                     columns.column_mappings,
+                                     columns.inserter_defs);
+  InsertPlan plan{schema, &error, statistics};
+
+  ChunkPrefetcher prefetcher{stream, schema->n_children, queue_depth};
+  while (auto chunk = prefetcher.Next()) {
+    // the plan only borrows the chunk buffers, so it must be re-bound
+    // before the chunk is released on the next iteration
+    plan.Bind(chunk->get(), &error);
+    plan.InsertRows(inserter, (*chunk)->length);
+  }
+
+  inserter.execute();
+  return plan.TakeStatistics();
+}
+
+///
+/// When set, how often a load commits and under which key it records its
+/// progress. Thresholds of zero are disabled.
+///
+struct CheckpointOptions {
+  std::string key;
+  size_t rows;
+  size_t bytes;
+};
+
+// the number of stream rows each checkpointed load has committed per table;
+// a load removes its entries once it completes
+static const hyperapi::TableName CheckpointTableName{
+    hyperapi::SchemaName{"public"}, "__pantab_checkpoints"};
+
+static auto CreateCheckpointTable(hyperapi::Connection &connection) -> void {
+  const hyperapi::TableDefinition table_def{
+      CheckpointTableName,
+      {{"checkpoint_key", hyperapi::SqlType::text(),
+        hyperapi::Nullability::NotNullable},
+       {"table_name", hyperapi::SqlType::text(),
+        hyperapi::Nullability::NotNullable},
+       {"committed_rows", hyperapi::SqlType::bigInt(),
+        hyperapi::Nullability::NotNullable}}};
+  connection.getCatalog().createTableIfNotExists(table_def);
+}
+
+static auto CheckpointCondition(const std::string &key,
+                                const hyperapi::TableName &table_name)
+    -> std::string {
+  return "checkpoint_key = " + hyperapi::escapeStringLiteral(key) +
+         " AND table_name = " +
+         hyperapi::escapeStringLiteral(table_name.toString());
+}
+
+static auto GetCommittedRows(hyperapi::Connection &connection,
+                             const std::string &key,
+                             const hyperapi::TableName &table_name)
+    -> int64_t {
+  return connection.executeScalarQuery<int64_t>(
+      "SELECT COALESCE(MAX(committed_rows), 0) FROM " +
+      CheckpointTableName.toString() + " WHERE " +
+      CheckpointCondition(key, table_name));
+}
+
+static auto RecordCheckpoint(hyperapi::Connection &connection,
+                             const std::string &key,
+                             const hyperapi::TableName &table_name,
+                             int64_t committed_rows) -> void {
+  connection.executeCommand("DELETE FROM " + CheckpointTableName.toString() +
+                            " WHERE " + CheckpointCondition(key, table_name));
+  connection.executeCommand(
+      "INSERT INTO " + CheckpointTableName.toString() + " VALUES (" +
+      hyperapi::escapeStringLiteral(key) + ", " +
+      hyperapi::escapeStringLiteral(table_name.toString()) + ", " +
+      std::to_string(committed_rows) + ")");
+}
+
+///
+/// Removes the entries of a completed load, and the checkpoint table along
+/// with them once no other load has any left
+///
+static auto ClearCheckpoints(hyperapi::Connection &connection,
+                             const std::string &key) -> void {
+  connection.executeCommand("DELETE FROM " + CheckpointTableName.toString() +
+                            " WHERE checkpoint_key = " +
+                            hyperapi::escapeStringLiteral(key));
+  if (connection.executeScalarQuery<int64_t>(
+          "SELECT COUNT(*) FROM " + CheckpointTableName.toString()) == 0) {
+    connection.executeCommand("DROP TABLE " + CheckpointTableName.toString());
+  }
+}
+
+///
+/// Streams every chunk into an existing table, committing whenever a
+/// checkpoint threshold is reached. Each commit records the number of stream
+/// rows consumed in the same transaction, and the rows committed by an
+/// earlier attempt of the load are skipped. Collected statistics are folded
+/// in with every commit. Must be called without the GIL held.
+///
+static auto InsertStreamCheckpointed(hyperapi::Connection &connection,
+                                     const PreparedTable &prepared,
+                                     const struct ArrowSchema *schema,
+                                     struct ArrowArrayStream *stream,
+                                     size_t queue_depth,
+                                     const CheckpointOptions &checkpoint,
+                                     bool statistics) -> void {
+  struct ArrowError error {};
+  const auto &table_name = prepared.definition.getTableName();
+  const auto committed_rows =
+      GetCommittedRows(connection, checkpoint.key, table_name);
+  InsertPlan plan{schema, &error, statistics};
+
+  // the inserter is declared last so that a failure discards its rows before
+  // the transaction rolls back
+  std::optional<Transaction> transaction;
+  std::optional<hyperapi::Inserter> inserter;
+  int64_t consumed_rows = 0;
+  size_t pending_rows = 0;
+  size_t pending_bytes = 0;
+  std::vector<int64_t> resumed_rows;
+
+  const auto commit = [&] {
+    inserter->execute();
+    inserter.reset();
+    if (statistics) {
+      const std::array batches{plan.TakeStatistics()};
+      RecordStatistics(connection, prepared.definition, batches,
+                       std::nullopt);
+    }
+    RecordCheckpoint(connection, checkpoint.key, table_name, consumed_rows);
+    transaction->Commit();
+    transaction.reset();
+    pending_rows = 0;
+    pending_bytes = 0;
+  };
+
+  ChunkPrefetcher prefetcher{stream, schema->n_children, queue_depth};
+  while (auto chunk = prefetcher.Next()) {
+    const auto length = (*chunk)->length;
+    const auto skip =
+        std::clamp(committed_rows - consumed_rows, int64_t{0}, length);
+    consumed_rows += length;
+    if (skip == length) {
+      continue;
+    }
+
+    if (!inserter) {
+      transaction.emplace(connection);
+      inserter.emplace(connection, prepared.definition,
+                       prepared.columns.column_mappings,
+                       prepared.columns.inserter_defs);
+    }
+
+    plan.Bind(chunk->get(), &error);
+    if (skip == 0) {
+      plan.InsertRows(*inserter, length);
+    } else {
+      // the chunk straddles the last checkpoint of an earlier attempt
+      resumed_rows.resize(static_cast<size_t>(length - skip));
+      std::iota(resumed_rows.begin(), resumed_rows.end(), skip);
+      plan.InsertRowsAt(*inserter, resumed_rows);
+    }
+    pending_rows += static_cast<size_t>(length - skip);
+    pending_bytes += static_cast<size_t>(plan.BoundBytes());
+
+    if ((checkpoint.rows != 0 && pending_rows >= checkpoint.rows) ||
+        (checkpoint.bytes != 0 && pending_bytes >= checkpoint.bytes)) {
+      commit();
+    }
+  }
+
+  if (inserter) {
+    commit();
+  }
+}
+
+///
+/// A scratch directory holding staging databases, removed along with its
+/// contents on destruction
+///
+class StagingDirectory {
+public:
+  StagingDirectory() {
+    std::random_device random_device{};
+    do {
+      path_ = std::filesystem::temp_directory_path() /
+              ("pantab_staging_" + std::to_string(random_device()));
+    } while (!std::filesystem::create_directory(path_));
+  }
+
+  StagingDirectory(const StagingDirectory &) = delete;
+  auto operator=(const StagingDirectory &) -> StagingDirectory & = delete;
+  StagingDirectory(StagingDirectory &&) = delete;
+  auto operator=(StagingDirectory &&) -> StagingDirectory & = delete;
+
+  ~StagingDirectory() {
+    std::error_code ec;
+    std::filesystem::remove_all(path_, ec);
+  }
+
+  auto DatabasePath(size_t table_idx, size_t shard_idx = 0) const
+      -> std::string {
+    const auto filename = "staging_" + std::to_string(table_idx) + "_" +
+                          std::to_string(shard_idx) + ".hyper";
+    return (path_ / filename).string();
+  }
+
+private:
+  std::filesystem::path path_;
+};
+
+static const hyperapi::TableName StagingTableName{
+    hyperapi::SchemaName{"public"}, "staging"};
+
+///
+/// Encodes a stream into a fresh staging database through a connection of its
+/// own, so that several streams can be encoded in parallel
+///
+static auto WriteStagingDatabase(const hyperapi::Endpoint &endpoint,
+                                 const std::string &staging_path,
+                                 const PreparedTable &prepared,
+                                 TableStream &table, size_t queue_depth,
+                                 bool statistics) -> BatchStatistics {
+  hyperapi::Connection connection{endpoint, staging_path,
+                                  hyperapi::CreateMode::Create};
+  const hyperapi::TableDefinition staging_def{
+      StagingTableName, prepared.definition.getColumns()};
+  connection.getCatalog().createTable(staging_def);
+
+  return InsertStream(connection, staging_def, prepared.columns,
+                      table.schema.get(), table.stream.get(), queue_depth,
+                      statistics);
+}
+
+///
+/// The staging table of an attached staging database
+///
+static auto StagingSource(const hyperapi::DatabaseName &alias)
+    -> hyperapi::TableName {
+  return {alias, *StagingTableName.getSchemaName(), StagingTableName.getName()};
+}
+
+///
+/// Copies the contents of an attached staging database into the target table
+/// within hyperd
+///
+static auto MergeStagingDatabase(hyperapi::Connection &connection,
+                                 const hyperapi::DatabaseName &alias,
+                                 const hyperapi::TableName &target) -> void {
+  const auto source = StagingSource(alias);
+  connection.executeCommand("INSERT INTO " + target.toString() +
+                            " SELECT * FROM " + source.toString());
+}
+
+///
+/// A condition on rows of the target table aliased as pantab_target, holding
+/// when their key columns match those of any row in source, a table or
+/// parenthesized query. Null keys match each other.
+///
+static auto MatchingRowsCondition(const std::string &source,
+                                  const std::vector<hyperapi::Name> &keys)
+    -> std::string {
+  std::string condition;
+  for (const auto &key : keys) {
+    if (!condition.empty()) {
+      condition += " AND ";
+    }
+    condition += "pantab_target." + key.toString() +
+                 " IS NOT DISTINCT FROM pantab_source." + key.toString();
+  }
+
+  return "EXISTS (SELECT 1 FROM " + source + " AS pantab_source WHERE " +
+         condition + ")";
+}
+
+///
+/// Deletes the rows of the target table whose key columns match those of any
+/// row in source
+///
+static auto DeleteMatchingRows(hyperapi::Connection &connection,
+                               const hyperapi::TableName &target,
+                               const std::string &source,
+                               const std::vector<hyperapi::Name> &keys)
+    -> void {
+  connection.executeCommand("DELETE FROM " + target.toString() +
+                            " AS pantab_target WHERE " +
+                            MatchingRowsCondition(source, keys));
+}
+
+///
+/// Counts the rows and nulls of the rows DeleteMatchingRows would delete,
+/// which takes the same join against the incoming rows
+///
+static auto CountMatchingRows(hyperapi::Connection &connection,
+                              const hyperapi::TableDefinition &target,
+                              const std::string &source,
+                              const std::vector<hyperapi::Name> &keys)
+    -> BatchStatistics {
+  return AggregateStatistics(
+      connection, target.getColumns(),
+      "(SELECT * FROM " + target.getTableName().toString() +
+          " AS pantab_target WHERE " + MatchingRowsCondition(source, keys) +
+          ")",
+      StatisticsAggregates::Counts);
+}
+
+///
+/// Hands out the chunks of a single stream to several shard workers, along
+/// with the position of each chunk's first row within the stream
+///
+class ShardedChunkSource {
+public:
+  ShardedChunkSource(struct ArrowArrayStream *stream, int64_t n_columns,
+                     size_t queue_depth)
+      : prefetcher_{stream, n_columns, queue_depth} {}
+
+  auto Next() -> std::optional<std::pair<nanoarrow::UniqueArray, int64_t>> {
+    const std::lock_guard lock{mutex_};
+    if (cancelled_) {
+      return std::nullopt;
+    }
+
+    auto chunk = prefetcher_.Next();
+    if (!chunk) {
+      return std::nullopt;
+    }
+
+    const auto first_row = next_row_;
+    next_row_ += (*chunk)->length;
+    return std::make_pair(std::move(*chunk), first_row);
+  }
+
+  ///
+  /// Stops handing out chunks, so that the remaining shards wind down once
+  /// one of them fails
+  ///
+  auto Cancel() -> void {
+    const std::lock_guard lock{mutex_};
+    cancelled_ = true;
+  }
+
+private:
+  std::mutex mutex_;
+  ChunkPrefetcher prefetcher_;
+  int64_t next_row_{};
+  bool cancelled_{};
+};
+
+// tracks the stream position of each row across shards, so that the merge
+// can restore the original row order
+static const hyperapi::Name ShardOrdinalName{"__pantab_row"};
+
+///
+/// Encodes whatever chunks one shard worker receives into a staging database
+/// of its own, tagging each row with its position in the stream
+///
+static auto WriteShardDatabase(const hyperapi::Endpoint &endpoint,
+                               const std::string &staging_path,
+                               const PreparedTable &prepared,
+                               const struct ArrowSchema *schema,
+                               ShardedChunkSource &source, bool statistics)
+    -> BatchStatistics {
+  hyperapi::Connection connection{endpoint, staging_path,
+                                  hyperapi::CreateMode::Create};
+
+  const hyperapi::TableDefinition::Column ordinal_column{
+      ShardOrdinalName, hyperapi::SqlType::bigInt(),
+      hyperapi::Nullability::NotNullable};
+  auto hyper_columns = prepared.definition.getColumns();
+  hyper_columns.emplace_back(ordinal_column);
+  const hyperapi::TableDefinition staging_def{StagingTableName,
+                                              std::move(hyper_columns)};
+  connection.getCatalog().createTable(staging_def);
+
+  auto column_mappings = prepared.columns.column_mappings;
+  column_mappings.emplace_back(ShardOrdinalName);
+  auto inserter_defs = prepared.columns.inserter_defs;
+  inserter_defs.emplace_back(ordinal_column);
+
+  struct ArrowError error {};
+  auto inserter = hyperapi::Inserter(connection, staging_def, column_mappings,
+                                     inserter_defs);
+  InsertPlan plan{schema, &error, statistics};
+  while (auto next = source.Next()) {
+    auto &[chunk, first_row] = *next;
+    plan.Bind(chunk.get(), &error);
+    plan.InsertRows(inserter, chunk->length, first_row);
+  }
+
+  inserter.execute();
+  return plan.TakeStatistics();
+}
+
+///
+/// A parenthesized query over the staging tables of every attached shard
+/// database of a table
+///
+static auto ShardUnionQuery(std::span<const hyperapi::DatabaseName> aliases)
+    -> std::string {
+  std::string union_query;
+  for (const auto &alias : aliases) {
+    if (!union_query.empty()) {
+      union_query += " UNION ALL ";
+    }
+    union_query += "SELECT * FROM " + StagingSource(alias).toString();
+  }
+  return "(" + union_query + ")";
+}
+
+///
+/// Copies the rows of every attached shard database of a table into the
+/// target table within hyperd, in their original stream order
+///
+static auto MergeShardDatabases(hyperapi::Connection &connection,
+                                std::span<const hyperapi::DatabaseName> aliases,
+                                const PreparedTable &prepared) -> void {
+  std::string column_list;
+  for (const auto &column : prepared.definition.getColumns()) {
+    if (!column_list.empty()) {
+      column_list += ", ";
+    }
+    column_list += column.getName().toString();
+  }
+
+  connection.executeCommand(
+      "INSERT INTO " + prepared.definition.getTableName().toString() + " (" +
+      column_list + ") SELECT " + column_list + " FROM " +
+      ShardUnionQuery(aliases) + " AS shards ORDER BY " +
+      ShardOrdinalName.toString());
+}
+
+///
+/// Runs task(idx) for every idx in [0, ntasks) on up to max_workers threads.
+/// Once a task fails no further tasks are started, and the first failure is
+/// rethrown after every worker has finished.
+///
+template <typename F>
+static auto RunParallel(size_t ntasks, size_t max_workers, const F &task)
+    -> void {
+  std::atomic<size_t> next_task{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  const auto worker = [&] {
+    while (!failed) {
+      const auto idx = next_task.fetch_add(1);
+      if (idx >= ntasks) {
+        return;
+      }
+
+      try {
+        task(idx);
+      } catch (...) {
+        const std::lock_guard lock{error_mutex};
+        if (!error) {
+          error = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+  };
+
+  {
+    std::vector<std::jthread> threads;
+    for (size_t i = 0; i < std::min(ntasks, max_workers); i++) {
+      threads.emplace_back(worker);
+    }
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+///
+/// Ensures that every key column of a merge is part of the table
+///
+static auto AssertHasKeyColumns(const hyperapi::TableDefinition &table_def,
+                                const std::vector<hyperapi::Name> &keys)
+    -> void {
+  const auto &columns = table_def.getColumns();
+  for (const auto &key : keys) {
+    if (std::ranges::none_of(columns, [&](const auto &column) {
+          return column.getName() == key;
+        })) {
+      throw std::invalid_argument("Key column " + key.toString() +
+                                  " not found in table " +
+                                  table_def.getTableName().toString());
+    }
+  }
+}
+
+static auto GetCreateMode(const std::string &table_mode)
+    -> hyperapi::CreateMode {
+  // TODO: we don't have separate table / database create modes in the API
+  // but probably should; for now we infer this from table mode
+  return table_mode == "w" ? hyperapi::CreateMode::CreateAndReplace
+                           : hyperapi::CreateMode::CreateIfNotExists;
+}
+
+void write_to_hyper(
+    const nb::object &dict_of_capsules, const std::string &path,
+    const std::string &table_mode, const nb::iterable not_null_columns,
+    const nb::iterable json_columns, const nb::iterable geo_columns,
+    std::unordered_map<std::string, std::string> &&process_params,
+    size_t queue_depth, size_t max_workers, size_t shards,
+    const std::vector<std::string> &key_columns, bool transactional,
+    const std::string &checkpoint_key, size_t checkpoint_rows,
+    size_t checkpoint_bytes, const std::string &statistics,
+    const Session *session) {
+
+  const ColumnOptions options{ToStringSet(not_null_columns),
+                              ToStringSet(json_columns),
+                              ToStringSet(geo_columns)};
+  const bool merge = table_mode == "m";
+  const auto statistics_mode = ToStatisticsMode(statistics);
+  const bool collect = statistics_mode == StatisticsMode::Collect;
+  const std::vector<hyperapi::Name> keys{key_columns.begin(),
+                                         key_columns.end()};
+
+  std::vector<TableStream> tables;
+  for (auto const &[name, capsule] :
+       nb::cast<nb::dict>(dict_of_capsules, false)) {
+    tables.emplace_back(MakeTableStream(name, capsule));
+  }
+
+  auto session_state = GetSessionState(session);
+
+  // Everything past this point is Hyper I/O or native encoding. The streams
+  // may still be implemented in Python, so they are released only once the
+  // GIL is re-acquired, and the prefetcher re-acquires it around each read.
+  const nb::gil_scoped_release release{};
+
+  // declared ahead of the process so that hyperd has let go of the staging
+  // databases by the time they are removed
+  std::optional<StagingDirectory> staging;
+
+  auto columns = MakeAllTableColumns(tables, options);
+
+  const auto hyper = GetOrCreateSession(std::move(session_state),
+                                        std::move(process_params));
+  hyper->DropConnections(path);
+  hyperapi::Connection connection{hyper->GetEndpoint(), path,
+                                  GetCreateMode(table_mode)};
+
+  const auto prepared = PrepareAllTables(connection, tables,
+                                         std::move(columns), table_mode);
+  if (merge) {
+    for (const auto &table : prepared) {
+      AssertHasKeyColumns(table.definition, keys);
+    }
+  }
+
+  // checkpointed loads commit as they go, so they never share a transaction
+  if (!checkpoint_key.empty()) {
+    const CheckpointOptions checkpoint{checkpoint_key, checkpoint_rows,
+                                       checkpoint_bytes};
+    CreateTables(connection, prepared);
+    PrepareStatistics(connection, prepared, statistics_mode);
+    CreateCheckpointTable(connection);
+    for (size_t i = 0; i < tables.size(); i++) {
+      InsertStreamCheckpointed(connection, prepared[i],
+                               tables[i].schema.get(),
+                               tables[i].stream.get(), queue_depth,
+                               checkpoint, collect);
+    }
+    ClearCheckpoints(connection, checkpoint_key);
+    if (statistics_mode == StatisticsMode::Rescan) {
+      RescanStatistics(connection, prepared);
+    }
+    return;
+  }
+
+  // merging always goes through staging databases, which give the incoming
+  // rows a table to be matched against
+  if (!merge && shards <= 1 && (max_workers <= 1 || tables.size() <= 1)) {
+    // Hyper commits every statement outside of a transaction on its own, so
+    // several tables share one transaction even when atomicity was not asked
+    // for. The cost of a write then follows its rows, not its tables.
+    std::optional<Transaction> transaction;
+    if (transactional || tables.size() > 1) {
+      transaction.emplace(connection);
+    }
+    CreateTables(connection, prepared);
+    PrepareStatistics(connection, prepared, statistics_mode);
+    for (size_t i = 0; i < tables.size(); i++) {
+      const auto batch = InsertStream(
+          connection, prepared[i].definition, prepared[i].columns,
+          tables[i].schema.get(), tables[i].stream.get(), queue_depth,
+          collect);
+      if (collect) {
+        RecordStatistics(connection, prepared[i].definition,
+                         std::span{&batch, 1}, std::nullopt);
+      }
+    }
+    if (statistics_mode == StatisticsMode::Rescan) {
+      RescanStatistics(connection, prepared);
+    }
+    if (transaction) {
+      transaction->Commit();
+    }
+    return;
+  }
+
+  // each worker encodes its tables (or shards of a table) into staging
+  // databases through a connection of its own; hyperd then copies the staged
+  // rows into the target tables, which keeps all writes to the target on a
+  // single connection
+  staging.emplace();
+  const auto endpoint = hyper->GetEndpoint();
+  const auto nshards = std::max(shards, size_t{1});
+  // each worker only writes the statistics of its own table and shard
+  std::vector<std::vector<BatchStatistics>> batches(
+      tables.size(), std::vector<BatchStatistics>(nshards));
+  RunParallel(tables.size(), max_workers, [&](size_t idx) {
+    auto &table = tables[idx];
+    if (shards <= 1) {
+      batches[idx].front() =
+          WriteStagingDatabase(endpoint, staging->DatabasePath(idx),
+                               prepared[idx], table, queue_depth, collect);
+      return;
+    }
+
+    ShardedChunkSource source{table.stream.get(), table.schema->n_children,
+                              queue_depth};
+    RunParallel(shards, shards, [&](size_t shard_idx) {
+      try {
+        batches[idx][shard_idx] = WriteShardDatabase(
+            endpoint, staging->DatabasePath(idx, shard_idx), prepared[idx],
+            table.schema.get(), source, collect);
+      } catch (...) {
+        source.Cancel();
+        throw;
+      }
+    });
+  });
+
+  // every staging database is attached up front so that the merges can share
+  // a single transaction
+  const hyperapi::Catalog &catalog = connection.getCatalog();
+  std::vector<std::vector<hyperapi::DatabaseName>> aliases(tables.size());
+  for (size_t i = 0; i < tables.size(); i++) {
+    for (size_t shard_idx = 0; shard_idx < nshards; shard_idx++) {
+      const auto &alias = aliases[i].emplace_back(
+          "pantab_staging_" + std::to_string(i) + "_" +
+          std::to_string(shard_idx));
+      catalog.attachDatabase(staging->DatabasePath(i, shard_idx), alias);
+    }
+  }
+
+  {
+    std::optional<Transaction> transaction;
+    if (transactional || merge || tables.size() > 1) {
+      transaction.emplace(connection);
+    }
+    CreateTables(connection, prepared);
+    PrepareStatistics(connection, prepared, statistics_mode);
+    for (size_t i = 0; i < tables.size(); i++) {
+      std::optional<BatchStatistics> removed;
+      if (merge) {
+        const auto source = shards <= 1
+                                ? StagingSource(aliases[i].front()).toString()
+                                : ShardUnionQuery(aliases[i]);
+        if (collect) {
+          removed = CountMatchingRows(connection, prepared[i].definition,
+                                      source, keys);
+        }
+        DeleteMatchingRows(connection, prepared[i].definition.getTableName(),
+                           source, keys);
+      }
+      if (shards <= 1) {
+        MergeStagingDatabase(connection, aliases[i].front(),
+                             prepared[i].definition.getTableName());
+      } else {
+        MergeShardDatabases(connection, aliases[i], prepared[i]);
+      }
+      if (collect) {
+        RecordStatistics(connection, prepared[i].definition, batches[i],
+                         removed);
+      }
+    }
+    if (statistics_mode == StatisticsMode::Rescan) {
+      RescanStatistics(connection, prepared);
+    }
+    if (transaction) {
+      transaction->Commit();
+    }
+  }
+
+  for (const auto &table_aliases : aliases) {
+    for (const auto &alias : table_aliases) {
+      catalog.detachDatabase(alias);
+    }
+  }
+}
+
+static constexpr std::string_view PartitionPlaceholder = "{partition}";
+
+static auto SubstitutePartition(std::string text, std::string_view key)
+    -> std::string {
+  for (auto pos = text.find(PartitionPlaceholder); pos != std::string::npos;
+       pos = text.find(PartitionPlaceholder, pos + key.size())) {
+    text.replace(pos, PartitionPlaceholder.size(), key);
+  }
+  return text;
+}
+
+///
+/// Whether a key would name one of the devices Windows reserves, which it
+/// does regardless of case or of any extension following the name
+///
+static auto IsWindowsDeviceName(std::string_view key) -> bool {
+  static constexpr std::array<std::string_view, 4> DeviceNames{"CON", "PRN",
+                                                               "AUX", "NUL"};
+  static constexpr std::array<std::string_view, 2> NumberedDeviceNames{
+      "COM", "LPT"};
+  static constexpr size_t NumberedDeviceLength = 4;
+
+  std::string stem{key.substr(0, key.find('.'))};
+  std::ranges::transform(stem, stem.begin(), [](char c) {
+    return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+  });
+  if (std::ranges::find(DeviceNames, stem) != DeviceNames.end()) {
+    return true;
+  }
+  return stem.size() == NumberedDeviceLength && stem[3] >= '1' &&
+         stem[3] <= '9' &&
+         std::ranges::find(NumberedDeviceNames, stem.substr(0, 3)) !=
+             NumberedDeviceNames.end();
+}
+
+///
+/// Partition keys are arbitrary column values, so before a key becomes part
+/// of a file path every byte that could leave the templated directory or
+/// form an invalid name on Windows is percent-encoded:
+///
+/// - path separators, control characters (NUL included) and the characters
+///   Windows reserves, ':' < > " | ? *
+/// - trailing dots and spaces, which Windows strips, and with them keys made
+///   up of "." or ".." alone
+/// - the first character of a Windows device name, such as "CON"
+/// - "%" itself, which keeps the encoding reversible
+///
+/// An empty key has no encoding that cannot collide with another key, so it
+/// is rejected.
+///
+static auto EncodePathKey(std::string_view key) -> std::string {
+  static constexpr std::string_view HexDigits = "0123456789ABCDEF";
+  static constexpr std::string_view Reserved = R"(/\:*?"<>|%)";
+  static constexpr unsigned char FirstPrintable = 0x20;
+  static constexpr unsigned NibbleBits = 4;
+  static constexpr unsigned NibbleMask = 0xF;
+
+  if (key.empty()) {
+    throw std::invalid_argument(
+        "Partition keys cannot be empty when the database path contains " +
+        std::string{PartitionPlaceholder});
+  }
+
+  // everything past the last character other than a dot or space
+  const auto last_kept = key.find_last_not_of(". ");
+  const auto trailing_from =
+      last_kept == std::string_view::npos ? 0 : last_kept + 1;
+  const bool device_name = IsWindowsDeviceName(key);
+
+  std::string encoded;
+  encoded.reserve(key.size());
+  for (size_t i = 0; i < key.size(); i++) {
+    const char c = key[i];
+    const auto byte = static_cast<unsigned char>(c);
+    if (i >= trailing_from || (i == 0 && device_name) ||
+        byte < FirstPrintable || Reserved.find(c) != std::string_view::npos) {
+      encoded += '%';
+      encoded += HexDigits[byte >> NibbleBits];
+      encoded += HexDigits[byte & NibbleMask];
+    } else {
+      encoded += c;
+    }
+  }
+  return encoded;
+}
+
+///
+/// Where the rows of each partition go. Every occurrence of {partition} in the
+/// path, schema and table is replaced with the partition key, which is
+/// percent-encoded in the path.
+///
+struct PartitionTemplates {
+  std::string path;
+  std::optional<std::string> schema;
+  std::string table;
+
+  auto MakeTableName(std::string_view key) const -> hyperapi::TableName {
+    if (schema) {
+      return {SubstitutePartition(*schema, key),
+              SubstitutePartition(table, key)};
+    }
+    return {SubstitutePartition(table, key)};
+  }
+};
+
+static auto MakePartitionTemplates(const std::string &path,
+                                   const nb::handle &name)
+    -> PartitionTemplates {
+  std::tuple<std::string, std::string> schema_and_table;
+  std::string t_name;
+  if (nb::try_cast(name, schema_and_table, false)) {
+    return {path, std::get<0>(schema_and_table),
+            std::get<1>(schema_and_table)};
+  }
+  if (nb::try_cast(name, t_name, false)) {
+    return {path, std::nullopt, t_name};
+  }
+  throw nb::type_error("Expected string or tuple key");
+}
+
+///
+/// Renders the partition column of a chunk as text keys, one row at a time
+///
+class PartitionKeyReader {
+public:
+  PartitionKeyReader(const struct ArrowSchema *schema, struct ArrowError *error)
+      : name_{schema->name != nullptr ? schema->name : ""} {
+    if (ArrowArrayViewInitFromSchema(array_view_.get(), schema, error) != 0) {
+      throw std::runtime_error("Could not construct partition key reader: " +
+                               std::string{&error->message[0]});
+    }
+
+    switch (array_view_->storage_type) {
+    case NANOARROW_TYPE_INT8:
+    case NANOARROW_TYPE_INT16:
+    case NANOARROW_TYPE_INT32:
+    case NANOARROW_TYPE_INT64:
+    case NANOARROW_TYPE_UINT8:
+    case NANOARROW_TYPE_UINT16:
+    case NANOARROW_TYPE_UINT32:
+    case NANOARROW_TYPE_UINT64:
+    case NANOARROW_TYPE_STRING:
+    case NANOARROW_TYPE_LARGE_STRING:
+    case NANOARROW_TYPE_STRING_VIEW:
+      break;
+    default:
+      throw std::invalid_argument(
+          "Partition column '" + name_ +
+          "' must hold integers, strings or dictionary-encoded strings, got: " +
+          ArrowTypeString(array_view_->storage_type));
+    }
+
+    if (array_view_->dictionary != nullptr) {
+      switch (array_view_->dictionary->storage_type) {
+      case NANOARROW_TYPE_STRING:
+      case NANOARROW_TYPE_LARGE_STRING:
+      case NANOARROW_TYPE_STRING_VIEW:
+        break;
+      default:
+        throw std::invalid_argument(
+            "Partition column '" + name_ +
+            "' must hold integers, strings or dictionary-encoded strings");
+      }
+    }
+  }
+
+  auto Bind(const struct ArrowArray *array, struct ArrowError *error) -> void {
+    if (ArrowArrayViewSetArray(array_view_.get(), array, error) != 0) {
+      throw std::runtime_error("Could not set array view: " +
+                               std::string{&error->message[0]});
+    }
+  }
+
+  ///
+  /// Writes the key of row idx into out, reusing its allocation
+  ///
+  auto Read(int64_t idx, std::string &out) const -> void {
+    const auto *array_view = array_view_.get();
+    if (ArrowArrayViewIsNull(array_view, idx)) {
+      throw std::invalid_argument("Partition column '" + name_ +
+                                  "' cannot contain null values");
+    }
+
+    if (array_view->dictionary != nullptr) {
+      const auto key = ArrowArrayViewGetIntUnsafe(array_view, idx);
+      const auto value =
+          ArrowArrayViewGetStringUnsafe(array_view->dictionary, key);
+      out.assign(value.data, static_cast<size_t>(value.size_bytes));
+      return;
+    }
+
+    switch (array_view->storage_type) {
+    case NANOARROW_TYPE_UINT8:
+    case NANOARROW_TYPE_UINT16:
+    case NANOARROW_TYPE_UINT32:
+    case NANOARROW_TYPE_UINT64:
+      out = std::to_string(ArrowArrayViewGetUIntUnsafe(array_view, idx));
+      return;
+    case NANOARROW_TYPE_STRING:
+    case NANOARROW_TYPE_LARGE_STRING:
+    case NANOARROW_TYPE_STRING_VIEW: {
+      const auto value = ArrowArrayViewGetStringUnsafe(array_view, idx);
+      out.assign(value.data, static_cast<size_t>(value.size_bytes));
+      return;
+    }
+    default:
+      out = std::to_string(ArrowArrayViewGetIntUnsafe(array_view, idx));
+    }
+  }
+
+private:
+  std::string name_;
+  nanoarrow::UniqueArrayView array_view_;
+};
+
+///
+/// The database and table holding the rows of one partition. Partitions
+/// written into a shared database are staged in a database of their own.
+///
+struct PartitionTarget {
+  std::string path;
+  hyperapi::TableName table_name;
+};
+
+///
+/// Routes the rows of each partition to an inserter of its own, keeping at
+/// most max_open partitions open at a time. When the cap is reached the least
+/// recently used partition commits its rows and closes, to be reopened for
+/// appending should more of its rows arrive.
+///
+class PartitionRouter {
+public:
+  PartitionRouter(hyperapi::Endpoint endpoint, HyperSession &session,
+                  PartitionTemplates templates, const TableColumns &columns,
+                  std::string table_mode, size_t max_open,
+                  const StagingDirectory *staging)
+      : endpoint_{std::move(endpoint)}, session_{&session},
+        templates_{std::move(templates)}, columns_{&columns},
+        table_mode_{std::move(table_mode)}, max_open_{max_open},
+        staging_{staging} {}
+
+  auto Insert(const std::string &key, InsertPlan &plan,
+              std::span<const int64_t> rows) -> void {
+    auto &partition = GetOpenPartition(key);
+    plan.InsertRowsAt(*partition.inserter, rows);
+  }
+
+  ///
+  /// Commits the rows of every partition still open
+  ///
+  auto Close() -> void {
+    while (!open_.empty()) {
+      CloseLeastRecentlyUsed();
+    }
+  }
+
+  ///
+  /// Every partition written to, in the order they were first seen
+  ///
+  auto GetTargets() const -> const std::vector<PartitionTarget> & {
+    return targets_;
+  }
+
+private:
+  struct OpenPartition {
+    OpenPartition(std::string key_, hyperapi::Connection &&connection_)
+        : key{std::move(key_)}, connection{std::move(connection_)} {}
+
+    std::string key;
+    hyperapi::Connection connection;
+    // declared last, so that uncommitted rows are discarded before the
+    // connection closes
+    std::optional<hyperapi::Inserter> inserter;
+  };
+
+  auto GetOpenPartition(const std::string &key) -> OpenPartition & {
+    if (const auto it = open_index_.find(key); it != open_index_.end()) {
+      open_.splice(open_.begin(), open_, it->second);
+      return open_.front();
+    }
+
+    if (open_.size() >= max_open_) {
+      CloseLeastRecentlyUsed();
+    }
+
+    const auto [target_it, first_open] =
+        target_index_.try_emplace(key, targets_.size());
+    if (first_open) {
+      const auto path = staging_ != nullptr
+                            ? staging_->DatabasePath(targets_.size())
+                            : MakePartitionPath(key);
+      targets_.push_back({path, templates_.MakeTableName(key)});
+    }
+    const auto &target = targets_[target_it->second];
+
+    auto create_mode = hyperapi::CreateMode::None;
+    if (first_open) {
+      session_->DropConnections(target.path);
+      create_mode = staging_ != nullptr ? hyperapi::CreateMode::Create
+                                        : GetCreateMode(table_mode_);
+    }
+    auto &partition = open_.emplace_front(
+        key, hyperapi::Connection{endpoint_, target.path, create_mode});
+    open_index_.emplace(key, open_.begin());
+
+    const auto table_name =
+        staging_ != nullptr ? StagingTableName : target.table_name;
+    const hyperapi::TableDefinition table_def{table_name,
+                                              columns_->hyper_columns};
+    if (first_open) {
+      const auto prepared =
+          staging_ != nullptr
+              ? PreparedTable{table_def, *columns_, false}
+              : PrepareTable(partition.connection, table_name,
+                             TableColumns{*columns_}, table_mode_);
+      CreateTables(partition.connection, std::span{&prepared, 1});
+      PrepareStatistics(partition.connection, std::span{&prepared, 1},
+                        StatisticsMode::None);
+    }
+    partition.inserter.emplace(partition.connection, table_def,
+                               columns_->column_mappings,
+                               columns_->inserter_defs);
+    return partition;
+  }
+
+  ///
+  /// Substitutes a key into the database path. Case-insensitive file systems
+  /// (the default on Windows and macOS) map keys differing only in case to
+  /// the same file, which the second key would then replace, so such keys are
+  /// rejected. Only ASCII letters are folded.
+  ///
+  auto MakePartitionPath(const std::string &key) -> std::string {
+    auto path = SubstitutePartition(templates_.path, EncodePathKey(key));
+    std::string folded{path};
+    std::ranges::transform(folded, folded.begin(), [](char c) {
+      return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    });
+
+    const auto [it, inserted] = path_keys_.try_emplace(std::move(folded), key);
+    if (!inserted) {
+      throw std::invalid_argument(
+          "Partition keys '" + it->second + "' and '" + key +
+          "' resolve to the same file on case-insensitive file systems: " +
+          path);
+    }
+    return path;
+  }
+
+  auto CloseLeastRecentlyUsed() -> void {
+    auto &partition = open_.back();
+    partition.inserter->execute();
+    open_index_.erase(partition.key);
+    open_.pop_back();
+  }
+
+  hyperapi::Endpoint endpoint_;
+  HyperSession *session_;
+  PartitionTemplates templates_;
+  const TableColumns *columns_;
+  std::string table_mode_;
+  size_t max_open_;
+  const StagingDirectory *staging_;
+
+  std::vector<PartitionTarget> targets_;
+  std::unordered_map<std::string, size_t> target_index_;
+  // the key of each partition file, by case-folded path
+  std::unordered_map<std::string, std::string> path_keys_;
+  // most recently used first
+  std::list<OpenPartition> open_;
+  std::unordered_map<std::string, std::list<OpenPartition>::iterator>
+      open_index_;
+};
+
+void write_partitioned_to_hyper(
+    const nb::handle &capsule, const std::string &path,
+    const nb::handle &table, const std::string &partition_column,
+    const std::string &table_mode, const nb::iterable not_null_columns,
+    const nb::iterable json_columns, const nb::iterable geo_columns,
+    std::unordered_map<std::string, std::string> &&process_params,
+    size_t queue_depth, size_t max_open_partitions, const Session *session) {
+
+  const ColumnOptions options{ToStringSet(not_null_columns),
+                              ToStringSet(json_columns),
+                              ToStringSet(geo_columns)};
+  auto templates = MakePartitionTemplates(path, table);
+  auto [stream, schema] = ImportArrayStream(capsule);
+  auto session_state = GetSessionState(session);
+
+  const nb::gil_scoped_release release{};
+
+  // declared ahead of the process so that hyperd has let go of the staging
+  // databases by the time they are removed
+  std::optional<StagingDirectory> staging;
+
+  struct ArrowError error {};
+  const auto columns = MakeTableColumns(schema.get(), options, &error);
+
+  const std::span children{schema->children,
+                           static_cast<size_t>(schema->n_children)};
+  const auto partition_it =
+      std::ranges::find_if(children, [&](const auto *child) {
+        return child->name != nullptr && child->name == partition_column;
+      });
+  if (partition_it == children.end()) {
+    throw std::invalid_argument("Partition column '" + partition_column +
+                                "' not found");
+  }
+  const auto partition_idx =
+      static_cast<size_t>(std::distance(children.begin(), partition_it));
+  PartitionKeyReader key_reader{*partition_it, &error};
+
+  const auto hyper = GetOrCreateSession(std::move(session_state),
+                                        std::move(process_params));
+
+  // without a placeholder in the path every partition lands in the same
+  // database, which cannot have several inserters open at once; partitions
+  // are then staged separately and copied over at the end
+  const bool shared_database =
+      path.find(PartitionPlaceholder) == std::string::npos;
+  if (shared_database) {
+    staging.emplace();
+  }
+
+  PartitionRouter router{hyper->GetEndpoint(),
+                         *hyper,
+                         std::move(templates),
+                         columns,
+                         table_mode,
+                         max_open_partitions,
+                         staging ? &*staging : nullptr};
+  InsertPlan plan{schema.get(), &error};
+
+  // row indices of each partition within the current chunk; the vectors keep
+  // their allocations from one chunk to the next
+  std::unordered_map<std::string, std::vector<int64_t>> partition_rows;
+  std::string key;
+
+  ChunkPrefetcher prefetcher{stream.get(), schema->n_children, queue_depth};
+  while (auto chunk = prefetcher.Next()) {
+    plan.Bind(chunk->get(), &error);
+    const std::span chunk_children{
+        (*chunk)->children, static_cast<size_t>((*chunk)->n_children)};
+    key_reader.Bind(chunk_children[partition_idx], &error);
+
+    for (auto &[_, rows] : partition_rows) {
+      rows.clear();
+    }
+    for (int64_t row_idx = 0; row_idx < (*chunk)->length; row_idx++) {
+      key_reader.Read(row_idx, key);
+      partition_rows[key].push_back(row_idx);
+    }
+
+    for (const auto &[partition_key, rows] : partition_rows) {
+      if (!rows.empty()) {
+        router.Insert(partition_key, plan, rows);
+      }
+    }
+  }
+  router.Close();
+
+  if (!shared_database) {
+    return;
+  }
+
+  hyper->DropConnections(path);
+  hyperapi::Connection connection{hyper->GetEndpoint(), path,
+                                  GetCreateMode(table_mode)};
+  const auto &targets = router.GetTargets();
+  const auto prepared = PrepareAllTables(
+      connection, targets, std::vector<TableColumns>(targets.size(), columns),
+      table_mode);
+
+  // every staging database is attached up front so that the partitions are
+  // copied over in a single transaction, leaving the target untouched should
+  // any of them fail
+  const hyperapi::Catalog &catalog = connection.getCatalog();
+  std::vector<hyperapi::DatabaseName> aliases;
+  aliases.reserve(targets.size());
+  for (size_t i = 0; i < targets.size(); i++) {
+    const auto &alias =
+        aliases.emplace_back("pantab_partition_" + std::to_string(i));
+    catalog.attachDatabase(targets[i].path, alias);
+  }
+
+  {
+    Transaction transaction{connection};
+    CreateTables(connection, prepared);
+    PrepareStatistics(connection, prepared, StatisticsMode::None);
+    for (size_t i = 0; i < targets.size(); i++) {
+      MergeStagingDatabase(connection, aliases[i],
+                           prepared[i].definition.getTableName());
+    }
+    transaction.Commit();
+  }
+
+  for (const auto &alias : aliases) {
+    catalog.detachDatabase(alias);
+  }
+}
+
+///
+/// A query reading the given files through Hyper's own reader, which casts
+/// every column to its type in the target table and names it accordingly
+///
+static auto ExternalFilesQuery(const hyperapi::TableDefinition &table_def,
+                               const std::vector<std::string> &files,
+                               const std::string &format) -> std::string {
+  std::string select_list;
+  // CSV files carry no types, so Hyper needs to be told how to parse them;
+  // JSON and GEOGRAPHY values are read as text and cast afterwards
+  std::string csv_descriptor;
+  for (const auto &column : table_def.getColumns()) {
+    if (!select_list.empty()) {
+      select_list += ", ";
+      csv_descriptor += ", ";
+    }
+    const auto escaped = column.getName().toString();
+    const auto &sqltype = column.getType();
+    select_list += "CAST(" + escaped + " AS " + GetSqlTypeName(sqltype) +
+                   ") AS " + escaped;
+
+    const auto tag = sqltype.getTag();
+    const bool parse_as_text = tag == hyperapi::TypeTag::Json ||
+                               tag == hyperapi::TypeTag::Geography;
+    csv_descriptor +=
+        escaped + " " + (parse_as_text ? "TEXT" : GetSqlTypeName(sqltype));
+  }
+
+  std::string file_list;
+  for (const auto &file : files) {
+    if (!file_list.empty()) {
+      file_list += ", ";
+    }
+    file_list += hyperapi::escapeStringLiteral(file);
+  }
+
+  std::string external_args = "ARRAY[" + file_list + "], FORMAT => " +
+                              hyperapi::escapeStringLiteral(format);
+  if (format == "csv") {
+    external_args +=
+        ", HEADER => true, COLUMNS => DESCRIPTOR(" + csv_descriptor + ")";
+  }
+
+  return "SELECT " + select_list + " FROM external(" + external_args + ")";
+}
+
+///
+/// Inserts the contents of the given files into the target table, returning
+/// their statistics if requested. Hyper does not report anything about the
+/// rows an INSERT reads, so collecting them reads the files a second time.
+///
+static auto CopyFilesIntoTable(hyperapi::Connection &connection,
+                               const hyperapi::TableDefinition &table_def,
+                               const std::vector<std::string> &files,
+                               const std::string &format, bool statistics)
+    -> BatchStatistics {
+  std::string column_list;
+  for (const auto &column : table_def.getColumns()) {
+    if (!column_list.empty()) {
+      column_list += ", ";
+    }
+    column_list += column.getName().toString();
+  }
+
+  const auto query = ExternalFilesQuery(table_def, files, format);
+  connection.executeCommand("INSERT INTO " +
+                            table_def.getTableName().toString() + " (" +
+                            column_list + ") " + query);
+  if (!statistics) {
+    return {};
+  }
+  return AggregateStatistics(connection, table_def.getColumns(),
+                             "(" + query + ")", StatisticsAggregates::Ranges);
+}
+
+///
+/// A table to be bulk loaded from files Hyper can read directly
+///
+struct TableFiles {
+  hyperapi::TableName table_name;
+  nanoarrow::UniqueSchema schema;
+  std::vector<std::string> files;
+};
+
+static auto MakeTableFiles(const nb::handle &name, const nb::handle &source)
+    -> TableFiles {
+  const auto [schema_capsule, files] =
+      nb::cast<std::tuple<nb::object, std::vector<std::string>>>(source);
+  const auto c_schema = static_cast<struct ArrowSchema *>(
+      PyCapsule_GetPointer(schema_capsule.ptr(), "arrow_schema"));
+  if (c_schema == nullptr) {
+    throw std::invalid_argument("Invalid PyCapsule provided!");
+  }
+
+  return {ToTableName(name), nanoarrow::UniqueSchema{c_schema}, files};
+}
+
+void copy_to_hyper(
+    const nb::object &dict_of_sources, const std::string &path,
+    const std::string &format, const std::string &table_mode,
+    const nb::iterable not_null_columns, const nb::iterable json_columns,
+    const nb::iterable geo_columns,
+    std::unordered_map<std::string, std::string> &&process_params,
+    bool transactional, const std::string &statistics,
+    const Session *session) {
+
+  const ColumnOptions options{ToStringSet(not_null_columns),
+                              ToStringSet(json_columns),
+                              ToStringSet(geo_columns)};
+  const auto statistics_mode = ToStatisticsMode(statistics);
+  const bool collect = statistics_mode == StatisticsMode::Collect;
+
+  std::vector<TableFiles> tables;
+  for (auto const &[name, source] :
+       nb::cast<nb::dict>(dict_of_sources, false)) {
+    tables.emplace_back(MakeTableFiles(name, source));
+  }
+
+  auto session_state = GetSessionState(session);
+
+  // hyperd reads the files itself, so there is nothing left to do in Python
+  const nb::gil_scoped_release release{};
+
+  auto columns = MakeAllTableColumns(tables, options);
+
+  const auto hyper = GetOrCreateSession(std::move(session_state),
+                                        std::move(process_params));
+  hyper->DropConnections(path);
+  hyperapi::Connection connection{hyper->GetEndpoint(), path,
+                                  GetCreateMode(table_mode)};
+
+  const auto prepared = PrepareAllTables(connection, tables,
+                                         std::move(columns), table_mode);
+
+  std::optional<Transaction> transaction;
+  if (transactional || tables.size() > 1) {
+    transaction.emplace(connection);
+  }
+  CreateTables(connection, prepared);
+  PrepareStatistics(connection, prepared, statistics_mode);
+  for (size_t i = 0; i < tables.size(); i++) {
+    const auto batch =
+        CopyFilesIntoTable(connection, prepared[i].definition,
+                           tables[i].files, format, collect);
+    if (collect) {
+      RecordStatistics(connection, prepared[i].definition,
+                       std::span{&batch, 1}, std::nullopt);
+    }
+  }
+  if (statistics_mode == StatisticsMode::Rescan) {
+    RescanStatistics(connection, prepared);
+  }
+  if (transaction) {
+    transaction->Commit();
+  }
+}
+
+///
+/// Everything a TableWriter keeps open between writes. Members are destroyed
+/// in reverse order, so pending rows are discarded before the connection and
+/// then the process go away.
+///
+struct TableWriterState {
+  std::shared_ptr<HyperSession> session;
+  hyperapi::Connection connection;
+  hyperapi::TableName table_name;
+  std::string table_mode;
+  ColumnOptions options;
+  size_t flush_rows;
+  size_t flush_bytes;
+
+  std::optional<PreparedTable> prepared;
+  std::optional<hyperapi::Inserter> inserter;
+  size_t pending_rows{};
+  size_t pending_bytes{};
+};
+
+TableWriter::TableWriter(
+    const std::string &path, const nb::handle &table,
+    const std::string &table_mode, const nb::iterable not_null_columns,
+    const nb::iterable json_columns, const nb::iterable geo_columns,
+    std::unordered_map<std::string, std::string> &&process_params,
+    size_t flush_rows, size_t flush_bytes, const Session *session) {
+  auto table_name = ToTableName(table);
+  ColumnOptions options{ToStringSet(not_null_columns),
+                        ToStringSet(json_columns), ToStringSet(geo_columns)};
+  auto session_state = GetSessionState(session);
+
+  const nb::gil_scoped_release release{};
+  auto hyper = GetOrCreateSession(std::move(session_state),
+                                  std::move(process_params));
+  hyper->DropConnections(path);
+  hyperapi::Connection connection{hyper->GetEndpoint(), path,
+                                  GetCreateMode(table_mode)};
+
+  state_ = std::make_unique<TableWriterState>(TableWriterState{
+      std::move(hyper), std::move(connection), std::move(table_name),
+      table_mode, std::move(options), flush_rows, flush_bytes, std::nullopt,
+      std::nullopt});
+}
+
+TableWriter::~TableWriter() = default;
+
+auto TableWriter::GetState() -> TableWriterState & {
+  if (!state_) {
+    throw std::invalid_argument("TableWriter is closed");
+  }
+  return *state_;
+}
+
+auto TableWriter::Write(const nb::handle &capsule) -> void {
+  // the stream may be implemented in Python, so it has to be released with
+  // the GIL held
+  auto [stream, schema] = ImportArrayStream(capsule);
+
+  const nb::gil_scoped_release release{};
+  const std::lock_guard lock{mutex_};
+  auto &state = GetState();
+
+  struct ArrowError error {};
+  auto columns = MakeTableColumns(schema.get(), state.options, &error);
+  if (!state.prepared) {
+    state.prepared = PrepareTable(state.connection, state.table_name,
+                                  std::move(columns), state.table_mode);
+    CreateTables(state.connection, std::span{&*state.prepared, 1});
+    // the rows written through a TableWriter are not counted, so recorded
+    // statistics would go stale
+    PrepareStatistics(state.connection, std::span{&*state.prepared, 1},
+                      StatisticsMode::None);
+  } else {
+    AssertColumnsEqual(columns.hyper_columns,
+                       state.prepared->columns.hyper_columns);
+  }
+
+  // batches may differ in their Arrow types as long as they map to the same
+  // Hyper types, so each one gets its own plan
+  InsertPlan plan{schema.get(), &error};
+  ChunkPrefetcher prefetcher{stream.get(), schema->n_children, 0};
+  try {
+    while (auto chunk = prefetcher.Next()) {
+      if (!state.inserter) {
+        const auto &prepared = *state.prepared;
+        state.inserter.emplace(state.connection, prepared.definition,
+                               prepared.columns.column_mappings,
+                               prepared.columns.inserter_defs);
+      }
+
+      plan.Bind(chunk->get(), &error);
+      plan.InsertRows(*state.inserter, (*chunk)->length);
+      state.pending_rows += static_cast<size_t>((*chunk)->length);
+      state.pending_bytes += static_cast<size_t>(plan.BoundBytes());
+
+      if ((state.flush_rows != 0 && state.pending_rows >= state.flush_rows) ||
+          (state.flush_bytes != 0 &&
+           state.pending_bytes >= state.flush_bytes)) {
+        FlushLocked(state);
+      }
+    }
+  } catch (...) {
+    // a failure can leave a partial row behind, so nothing since the last
+    // flush can be committed
+    state.inserter.reset();
+    state.pending_rows = 0;
+    state.pending_bytes = 0;
+    throw;
+  }
+}
+
+auto TableWriter::Flush() -> void {
+  const nb::gil_scoped_release release{};
+  const std::lock_guard lock{mutex_};
+  FlushLocked(GetState());
+}
+
+auto TableWriter::Close(bool commit) -> void {
+  const nb::gil_scoped_release release{};
+  const std::lock_guard lock{mutex_};
+  if (!state_) {
+    return;
+  }
+
+  // the state is dropped even if the final commit fails
+  const auto state = std::move(state_);
+  if (commit) {
+    FlushLocked(*state);
+  }
+}
+
+auto TableWriter::FlushLocked(TableWriterState &state) -> void {
+  if (!state.inserter) {
+    return;
+  }
+
+  // a new inserter is only opened once more rows arrive
+  auto inserter = std::move(*state.inserter);
+  state.inserter.reset();
+  state.pending_rows = 0;
+  state.pending_bytes = 0;
+  inserter.execute();
+}
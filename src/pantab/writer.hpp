@@ -1,10 +1,16 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+
 #include <nanobind/nanobind.h>
 #include <nanobind/stl/map.h>
 #include <nanobind/stl/string.h>
 #include <nanobind/stl/tuple.h>
 #include <nanobind/stl/unordered_map.h>
+#include <nanobind/stl/vector.h>
+
+#include "session.hpp"
 
 namespace nb = nanobind;
 
@@ -12,4 +18,70 @@ void write_to_hyper(
     const nb::object &dict_of_capsules, const std::string &path,
     const std::string &table_mode, const nb::iterable not_null_columns,
     const nb::iterable json_columns, const nb::iterable geo_columns,
-    std::unordered_map<std::string, std::string> &&process_params);
+    std::unordered_map<std::string, std::string> &&process_params,
+    size_t queue_depth, size_t max_workers, size_t shards,
+    const std::vector<std::string> &key_columns, bool transactional,
+    const std::string &checkpoint_key, size_t checkpoint_rows,
+    size_t checkpoint_bytes, const std::string &statistics,
+    const Session *session);
+
+///
+/// Splits a single stream into one table per distinct value of
+/// partition_column in one pass. Every {partition} in path and table is
+/// replaced with the value of the partition.
+///
+void write_partitioned_to_hyper(
+    const nb::handle &capsule, const std::string &path,
+    const nb::handle &table, const std::string &partition_column,
+    const std::string &table_mode, const nb::iterable not_null_columns,
+    const nb::iterable json_columns, const nb::iterable geo_columns,
+    std::unordered_map<std::string, std::string> &&process_params,
+    size_t queue_depth, size_t max_open_partitions, const Session *session);
+
+void copy_to_hyper(
+    const nb::object &dict_of_sources, const std::string &path,
+    const std::string &format, const std::string &table_mode,
+    const nb::iterable not_null_columns, const nb::iterable json_columns,
+    const nb::iterable geo_columns,
+    std::unordered_map<std::string, std::string> &&process_params,
+    bool transactional, const std::string &statistics,
+    const Session *session);
+
+struct TableWriterState;
+
+///
+/// Appends the batches written to it to a single table, keeping the Hyper
+/// connection and inserter open in between. Rows are committed whenever
+/// flush_rows rows or flush_bytes bytes of Arrow data are pending (a
+/// threshold of zero is disabled), on Flush, and on Close.
+///
+class TableWriter {
+public:
+  TableWriter(const std::string &path, const nb::handle &table,
+              const std::string &table_mode,
+              const nb::iterable not_null_columns,
+              const nb::iterable json_columns, const nb::iterable geo_columns,
+              std::unordered_map<std::string, std::string> &&process_params,
+              size_t flush_rows, size_t flush_bytes, const Session *session);
+  TableWriter(const TableWriter &) = delete;
+  auto operator=(const TableWriter &) -> TableWriter & = delete;
+  TableWriter(TableWriter &&) = delete;
+  auto operator=(TableWriter &&) -> TableWriter & = delete;
+  ~TableWriter();
+
+  auto Write(const nb::handle &capsule) -> void;
+  auto Flush() -> void;
+
+  ///
+  /// Commits pending rows if commit is true, or discards them otherwise, and
+  /// closes the connection
+  ///
+  auto Close(bool commit) -> void;
+
+private:
+  auto GetState() -> TableWriterState &;
+  static auto FlushLocked(TableWriterState &state) -> void;
+
+  std::mutex mutex_;
+  std::unique_ptr<TableWriterState> state_;
+};
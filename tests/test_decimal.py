@@ -139,3 +139,32 @@ def test_decimal_negative(tmp_hyper, compat):
     expected = tbl
 
     compat.assert_frame_equal(result, expected)
+
+
+def test_decimal_leading_fractional_zeros(tmp_hyper, compat):
+    schema = pa.schema(
+        [
+            ("small", pa.decimal128(10, 5)),
+            ("zero", pa.decimal128(38, 38)),
+        ]
+    )
+
+    tbl = pa.Table.from_arrays(
+        [
+            pa.array(["0.00500", "-0.00005", "12345.00001", "-0.10000", None]),
+            pa.array(["0", "0", "0", ".00000000000000000000000000000000000001", None]),
+        ],
+        schema=schema,
+    )
+
+    pt.frame_to_hyper(
+        tbl,
+        tmp_hyper,
+        table="decimals",
+        process_params={"default_database_version": "3"},
+    )
+
+    result = pt.frame_from_hyper(tmp_hyper, table="decimals", return_type="pyarrow")
+    expected = tbl
+
+    compat.assert_frame_equal(result, expected)
@@ -1,3 +1,5 @@
+import datetime
+import decimal
 import pathlib
 
 import pandas as pd
@@ -115,6 +117,23 @@ def test_read_varchar(tmp_hyper):
     tm.assert_frame_equal(result, expected)
 
 
+def test_read_large_binary_and_text_values(tmp_hyper):
+    pa = pytest.importorskip("pyarrow")
+    blobs = [bytes(range(256)) * 4096, None, b"", b"\x00" * 3, b"z" * 65_537]
+    texts = ["é" * 100_000, "", None, "a\x00b", "ü"]
+    tbl = pa.table({"id": range(len(blobs)), "blob": blobs, "text": texts})
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+    stream = pt.frame_from_hyper(
+        tmp_hyper, table="test", return_type="stream", chunk_size=2
+    )
+    result = pa.RecordBatchReader.from_stream(stream).read_all().sort_by("id")
+
+    assert result.column("blob").type == pa.large_binary()
+    assert result.column("blob").to_pylist() == blobs
+    assert result.column("text").to_pylist() == texts
+
+
 def test_reader_handles_duplicate_columns(tmp_hyper):
     column_name = "does_not_matter"
     tab_api = pytest.importorskip("tableauhyperapi")
@@ -223,6 +242,76 @@ def test_reader_prevents_sql_injection(
     pt.frame_from_hyper(tmp_hyper, table=table)
 
 
+def test_read_pushdown(tmp_hyper):
+    pa = pytest.importorskip("pyarrow")
+    tbl = pa.table(
+        {
+            "id": pa.array(range(6), type=pa.int64()),
+            "name": ["a", "b", "o'brien", None, "e", "f"],
+            "day": pa.array(
+                [datetime.date(2024, 1, d) for d in range(1, 7)], type=pa.date32()
+            ),
+            "score": [1.5, 2.5, None, 4.5, 5.5, 6.5],
+        }
+    )
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+
+    result = pt.frame_from_hyper(
+        tmp_hyper,
+        table="test",
+        return_type="pyarrow",
+        columns=["name", "id"],
+        filter=[
+            ("day", ">=", datetime.date(2024, 1, 2)),
+            ("name", "!=", None),
+            ("id", "not in", [4]),
+        ],
+    ).sort_by("id")
+    assert result.column_names == ["name", "id"]
+    assert result.column("id").to_pylist() == [1, 2, 5]
+    assert result.column("name").to_pylist() == ["b", "o'brien", "f"]
+
+    result = pt.frame_from_hyper(
+        tmp_hyper,
+        table="test",
+        return_type="pyarrow",
+        filter=[("name", "in", ["o'brien", "x' OR 't' = 't"])],
+    )
+    assert result.column("id").to_pylist() == [2]
+
+    result = pt.frame_from_hyper(
+        tmp_hyper, table="test", return_type="pyarrow", columns=["id"], limit=2
+    )
+    assert result.column_names == ["id"]
+    assert len(result) == 2
+
+    result = pt.frame_from_hyper(
+        tmp_hyper, table="test", return_type="pyarrow", filter=[("score", "==", None)]
+    )
+    assert result.column("id").to_pylist() == [2]
+
+
+@pytest.mark.parametrize(
+    "kwargs, exc, msg",
+    [
+        ({"columns": []}, ValueError, "'columns' must be a non-empty list"),
+        ({"columns": "id"}, ValueError, "'columns' must be a non-empty list"),
+        ({"limit": -1}, ValueError, "'limit' must be a non-negative integer"),
+        ({"filter": [("id", "~", 1)]}, ValueError, "Unsupported filter operator"),
+        ({"filter": [("id", "<", None)]}, ValueError, "cannot be compared with None"),
+        ({"filter": [("id", "in", [])]}, ValueError, "at least one value"),
+        ({"filter": [("id", "==")]}, ValueError, "must be a \\(column, operator"),
+        ({"filter": [("id", "==", b"x")]}, TypeError, "Unsupported filter value"),
+    ],
+)
+def test_read_pushdown_validation(tmp_hyper, kwargs, exc, msg):
+    frame = pd.DataFrame({"id": [1, 2, 3]})
+    pt.frame_to_hyper(frame, tmp_hyper, table="test")
+
+    with pytest.raises(exc, match=msg):
+        pt.frame_from_hyper(tmp_hyper, table="test", **kwargs)
+
+
 def test_read_batches(tmp_hyper, compat):
     pa = pytest.importorskip("pyarrow")
     tbl = pa.table({"int": pa.array(range(4), type=pa.int16())})
@@ -243,6 +332,139 @@ def test_read_batches(tmp_hyper, compat):
         rdr.read_next_batch()
 
 
+def test_read_batches_with_nulls(tmp_hyper, compat):
+    pa = pytest.importorskip("pyarrow")
+    tbl = pa.table(
+        {
+            "int": pa.array([1, None, 3, 4, None, 6, 7], type=pa.int64()),
+            "float": pa.array([None, 2.5, 3.5, None, 5.5, 6.5, None]),
+            "bool": pa.array([True, None, False, True, True, None, False]),
+            "string": pa.array(["a", None, "", "dd", None, "ffffff", "g"]),
+            "binary": pa.array([b"a", b"", None, b"ddd", None, b"f", b"gg"]),
+            "date": pa.array(
+                [0, -1, None, 19_000, None, -719_162, 2_932_896], type=pa.date32()
+            ),
+            "datetime": pa.array(
+                [0, None, -1, 1_700_000_000_000_000, None, 1, 2],
+                type=pa.timestamp("us"),
+            ),
+            "time": pa.array(
+                [0, None, 1, 86_399_999_999, None, 2, 3], type=pa.time64("us")
+            ),
+        }
+    )
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+    expected = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+
+    stream = pt.frame_from_hyper(
+        tmp_hyper, table="test", return_type="stream", chunk_size=3
+    )
+    batches = list(pa.RecordBatchReader.from_stream(stream))
+    assert [len(batch) for batch in batches] == [3, 3, 1]
+
+    result = pa.Table.from_batches(batches)
+    compat.assert_frame_equal(result, expected)
+    assert result.column("int").null_count == 2
+    assert result.column("date").to_pylist() == tbl.column("date").to_pylist()
+    assert (
+        result.column("datetime").to_pylist() == tbl.column("datetime").to_pylist()
+    )
+
+
+def test_read_batches_numerics(tmp_hyper):
+    pa = pytest.importorskip("pyarrow")
+    narrow = [decimal.Decimal(x) for x in ("1.25", "-0.01", "99999999.99")]
+    wide = [
+        decimal.Decimal(x)
+        for x in (
+            "-1234567890123456789012345678.0123456789",
+            "0.0000000001",
+            "9999999999999999999999999999.9999999999",
+        )
+    ]
+    tbl = pa.table(
+        {
+            "id": pa.array(range(4), type=pa.int64()),
+            "narrow": pa.array(narrow[:2] + [None] + narrow[2:], pa.decimal128(10, 2)),
+            "wide": pa.array([None] + wide, pa.decimal128(38, 10)),
+        }
+    )
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+    stream = pt.frame_from_hyper(
+        tmp_hyper, table="test", return_type="stream", chunk_size=3
+    )
+    result = pa.RecordBatchReader.from_stream(stream).read_all().sort_by("id")
+
+    assert result.column("narrow").to_pylist() == tbl.column("narrow").to_pylist()
+    assert result.column("wide").to_pylist() == tbl.column("wide").to_pylist()
+
+
+def test_read_batches_growing_strings(tmp_hyper):
+    pa = pytest.importorskip("pyarrow")
+    values = ["x" * (i * i) for i in range(40)] + [None, ""]
+    tbl = pa.table({"id": pa.array(range(len(values))), "string": values})
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+    stream = pt.frame_from_hyper(
+        tmp_hyper, table="test", return_type="stream", chunk_size=4
+    )
+    rdr = pa.RecordBatchReader.from_stream(stream)
+    assert rdr.schema.names == ["id", "string"]
+
+    result = rdr.read_all().sort_by("id")
+    assert result.column("string").to_pylist() == values
+
+
+@pytest.mark.parametrize("queue_depth", [1, 3])
+def test_read_batches_prefetched(tmp_hyper, compat, queue_depth):
+    pa = pytest.importorskip("pyarrow")
+    tbl = pa.table({"int": pa.array(range(10), type=pa.int16())})
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+    stream = pt.frame_from_hyper(
+        tmp_hyper,
+        table="test",
+        return_type="stream",
+        chunk_size=2,
+        queue_depth=queue_depth,
+    )
+
+    rdr = pa.RecordBatchReader.from_stream(stream)
+    batches = list(rdr)
+    assert [len(batch) for batch in batches] == [2] * 5
+    compat.assert_frame_equal(pa.Table.from_batches(batches), tbl)
+
+
+def test_read_prefetched_stream_released_early(tmp_hyper):
+    pa = pytest.importorskip("pyarrow")
+    tbl = pa.table({"int": pa.array(range(100), type=pa.int16())})
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+    stream = pt.frame_from_hyper(
+        tmp_hyper, table="test", return_type="stream", chunk_size=2, queue_depth=2
+    )
+
+    rdr = pa.RecordBatchReader.from_stream(stream)
+    assert len(rdr.read_next_batch()) == 2
+    # closing the reader must stop the background worker mid-stream
+    rdr.close()
+    del rdr, stream
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert len(result) == 100
+
+
+def test_read_negative_queue_depth_raises(tmp_hyper):
+    pa = pytest.importorskip("pyarrow")
+    tbl = pa.table({"int": pa.array(range(4), type=pa.int16())})
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+
+    with pytest.raises(ValueError, match="'queue_depth' must be a non-negative"):
+        pt.frame_from_hyper(tmp_hyper, table="test", queue_depth=-1)
+
+
 @pytest.mark.parametrize("return_type", ["polars", "pandas", "pyarrow"])
 def test_read_batches_without_capsule(tmp_hyper, compat, return_type):
     pa = pytest.importorskip("pyarrow")
@@ -267,3 +489,28 @@ def test_reader_can_enable_logging(tmp_hyper):
 
     assert (log_dir / "hyperd.log").exists()
     (log_dir / "hyperd.log").unlink()
+
+
+def test_reader_closed_session_raises(tmp_hyper):
+    df = pd.DataFrame(list(range(10)), columns=["nums"]).astype("int8")
+    pt.frame_to_hyper(df, tmp_hyper, table="test")
+
+    session = pt.Session()
+    session.close()
+    with pytest.raises(ValueError, match="Session is closed"):
+        pt.frame_from_hyper(tmp_hyper, table="test", session=session)
+
+
+def test_reader_session_with_process_params_raises(tmp_hyper):
+    df = pd.DataFrame(list(range(10)), columns=["nums"]).astype("int8")
+    pt.frame_to_hyper(df, tmp_hyper, table="test")
+
+    with pt.Session() as session:
+        msg = "'process_params' cannot be used with a 'session'"
+        with pytest.raises(ValueError, match=msg):
+            pt.frame_from_hyper(
+                tmp_hyper,
+                table="test",
+                session=session,
+                process_params={"default_database_version": "4"},
+            )
@@ -1,3 +1,4 @@
+import concurrent.futures
 import datetime
 import decimal
 
@@ -58,8 +59,9 @@ def test_basic(frame, roundtripped, tmp_hyper, table_name, table_mode, compat):
     compat.assert_frame_equal(result, expected)
 
 
+@pytest.mark.parametrize("max_workers", [1, 2])
 def test_multiple_tables(
-    frame, roundtripped, tmp_hyper, table_name, table_mode, compat
+    frame, roundtripped, tmp_hyper, table_name, table_mode, compat, max_workers
 ):
     return_type, expected = roundtripped
     if isinstance(frame, pa.Table) and return_type != "pyarrow":
@@ -76,6 +78,7 @@ def test_multiple_tables(
         json_columns={"json"},
         geo_columns={"geography"},
         process_params={"default_database_version": "4"},
+        max_workers=max_workers,
     )
     pt.frames_to_hyper(
         {table_name: frame, "table2": frame},
@@ -84,6 +87,7 @@ def test_multiple_tables(
         json_columns={"json"},
         geo_columns={"geography"},
         process_params={"default_database_version": "4"},
+        max_workers=max_workers,
     )
 
     result = pt.frames_from_hyper(tmp_hyper, return_type=return_type)
@@ -232,7 +236,8 @@ def test_date32_time_t_limits_roundtrip(tmp_hyper, compat):
     compat.assert_frame_equal(result, tbl)
 
 
-def test_chunked_data_roundtrip(frame, tmp_hyper, compat):
+@pytest.mark.parametrize("shards", [1, 3])
+def test_chunked_data_roundtrip(frame, tmp_hyper, compat, shards):
     if not isinstance(frame, pa.Table):
         pytest.skip("only testing for pyarrow roundtrip")
 
@@ -241,8 +246,93 @@ def test_chunked_data_roundtrip(frame, tmp_hyper, compat):
         tmp_hyper,
         table="test",
         process_params={"default_database_version": "4"},
+        shards=shards,
     )
     result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
     expected = frame.cast(result.schema)
 
     compat.assert_frame_equal(result, expected)
+
+
+def test_concurrent_roundtrips(tmp_path, compat):
+    # native work runs without the GIL, so independent calls may overlap
+    tbl = pa.table({"int": pa.array(range(1_000), type=pa.int64())})
+
+    def roundtrip(idx):
+        path = tmp_path / f"test_{idx}.hyper"
+        pt.frame_to_hyper(tbl.to_reader(100), path, table="test")
+        return pt.frame_from_hyper(path, table="test", return_type="pyarrow")
+
+    with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+        results = list(executor.map(roundtrip, range(4)))
+
+    for result in results:
+        compat.assert_frame_equal(result, tbl)
+
+
+@pytest.mark.parametrize("table_mode", ["w", "a"])
+def test_copy_engine_matches_inserter(tmp_path, table_mode, compat):
+    tbl = pa.table(
+        {
+            "int16": pa.array([1, None, -1], type=pa.int16()),
+            "int64": pa.array([2**40, 0, None], type=pa.int64()),
+            "float64": pa.array([1.5, None, -2.25], type=pa.float64()),
+            "bool": pa.array([True, False, None]),
+            "string": pa.array(["foo", None, "ünicode"]),
+            "binary": pa.array([b"\x00\x01", None, b""]),
+            "date32": pa.array(
+                [datetime.date(2024, 1, 1), None, datetime.date(1900, 12, 31)]
+            ),
+            "timestamp": pa.array(
+                [datetime.datetime(2024, 1, 1, 12, 30), None, None],
+                type=pa.timestamp("us"),
+            ),
+            "timestamp_utc": pa.array(
+                [None, datetime.datetime(2024, 1, 1), None],
+                type=pa.timestamp("us", "UTC"),
+            ),
+            "decimal": pa.array(
+                [decimal.Decimal("1.23"), None, decimal.Decimal("-99.99")],
+                type=pa.decimal128(10, 2),
+            ),
+        }
+    )
+
+    results = {}
+    for engine in ["inserter", "copy"]:
+        path = tmp_path / f"{engine}.hyper"
+        pt.frame_to_hyper(tbl, path, table="test", engine=engine)
+        if table_mode == "a":
+            pt.frame_to_hyper(tbl, path, table="test", table_mode="a", engine=engine)
+        results[engine] = pt.frame_from_hyper(
+            path, table="test", return_type="pyarrow"
+        )
+
+    compat.assert_frame_equal(results["copy"], results["inserter"])
+
+
+def test_session_roundtrips(tmp_hyper):
+    first = pa.table({"int": pa.array(range(3), type=pa.int64())})
+    second = pa.table({"int": pa.array(range(3, 5), type=pa.int64())})
+
+    with pt.Session() as session:
+        pt.frame_to_hyper(first, tmp_hyper, table="test", session=session)
+        result = pt.frame_from_hyper(
+            tmp_hyper, table="test", return_type="pyarrow", session=session
+        )
+        assert result == first
+
+        # replacing the database must not leave reads on the old file
+        pt.frame_to_hyper(second, tmp_hyper, table="test", session=session)
+        result = pt.frame_from_hyper(
+            tmp_hyper, table="test", return_type="pyarrow", session=session
+        )
+        assert result == second
+
+        pt.frame_to_hyper(
+            first, tmp_hyper, table="test", table_mode="a", session=session
+        )
+        result = pt.frames_from_hyper(tmp_hyper, return_type="pyarrow", session=session)
+        assert result[("public", "test")] == pa.concat_tables([second, first])
+
+    assert session.closed
@@ -1,17 +1,19 @@
 import datetime
+import decimal
 import re
 import unittest.mock
 
 import narwhals as nw
 import pandas as pd
 import pyarrow as pa
+import pyarrow.pandas_compat
 import pytest
 
 import pantab as pt
 
 
 def test_bad_table_mode_raises(frame, tmp_hyper):
-    msg = "'table_mode' must be either 'w' or 'a'"
+    msg = "'table_mode' must be one of 'w', 'a' or 'm'"
     with pytest.raises(ValueError, match=msg):
         pt.frame_to_hyper(
             frame,
@@ -269,6 +271,89 @@ def test_atomic_keyword_does_not_copy_or_move(
     mocked_move.assert_not_called()
 
 
+@unittest.mock.patch("shutil.copy")
+@unittest.mock.patch("shutil.move")
+def test_atomic_append_does_not_copy_or_move(mocked_copy, mocked_move, tmp_hyper):
+    tbl = pa.table({"int": pa.array(range(3), type=pa.int64())})
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test", table_mode="a")
+
+    mocked_copy.assert_not_called()
+    mocked_move.assert_not_called()
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result == pa.concat_tables([tbl, tbl])
+
+
+@pytest.mark.parametrize("max_workers", [1, 2])
+def test_failed_atomic_append_leaves_file_intact(tmp_hyper, max_workers):
+    tbl = pa.table({"int": pa.array(range(3), type=pa.int64())})
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+
+    def gen():
+        yield pa.record_batch({"int": pa.array([4, 5, 6])})
+        raise ValueError("stream went away")
+
+    reader = pa.RecordBatchReader.from_batches(tbl.schema, gen())
+
+    with pytest.raises(RuntimeError, match="stream went away"):
+        pt.frames_to_hyper(
+            {"other": tbl, "test": reader},
+            tmp_hyper,
+            table_mode="a",
+            max_workers=max_workers,
+        )
+
+    result = pt.frames_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert list(result) == [("public", "test")]
+    assert result[("public", "test")] == tbl
+
+
+@pytest.mark.parametrize("max_workers", [1, 2])
+def test_failed_non_atomic_multi_table_write_rolls_back(tmp_hyper, max_workers):
+    tbl = pa.table({"int": pa.array(range(3), type=pa.int64())})
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+
+    def gen():
+        yield pa.record_batch({"int": pa.array([4, 5, 6])})
+        raise ValueError("stream went away")
+
+    reader = pa.RecordBatchReader.from_batches(tbl.schema, gen())
+
+    # the tables of one call share a transaction even when not atomic, so the
+    # table written ahead of the failing one is rolled back as well
+    with pytest.raises(RuntimeError, match="stream went away"):
+        pt.frames_to_hyper(
+            {"other": tbl, "test": reader},
+            tmp_hyper,
+            table_mode="a",
+            atomic=False,
+            max_workers=max_workers,
+        )
+
+    result = pt.frames_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert list(result) == [("public", "test")]
+    assert result[("public", "test")] == tbl
+
+
+def test_writer_many_small_tables(tmp_hyper):
+    tbl = pa.table({"int": pa.array([1, 2], type=pa.int64())})
+    first = {f"table_{i}": tbl for i in range(50)}
+    first.update({("tenant", f"table_{i}"): tbl for i in range(50)})
+    pt.frames_to_hyper(first, tmp_hyper)
+
+    # appends to every existing table and creates new tables in a new schema
+    second = {**first, **{("other", f"table_{i}"): tbl for i in range(50)}}
+    pt.frames_to_hyper(second, tmp_hyper, table_mode="a")
+
+    result = pt.frames_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert len(result) == 150
+    for schema in ("public", "tenant"):
+        assert result[(schema, "table_0")] == pa.concat_tables([tbl, tbl])
+    assert result[("other", "table_49")] == tbl
+
+
 @pytest.mark.skip_asan
 def test_duplicate_columns_raises(tmp_hyper):
     frame = pd.DataFrame([[1, 1]], columns=[1, 1])
@@ -470,6 +555,26 @@ def test_write_date_bug(tmp_hyper):
     ]
 
 
+@pytest.mark.parametrize(
+    "arr,hyper_type",
+    [
+        (pa.array([0, None, -300_000_000_000], pa.timestamp("s")), "TIMESTAMP"),
+        (
+            pa.array([0, None, -300_000_000_000], pa.timestamp("s", "UTC")),
+            "TIMESTAMP_TZ",
+        ),
+        (pa.array([0, None, 100_000], pa.time32("s")), "TIME"),
+        (pa.array([0, None, -2_500_000], pa.date32()), "DATE"),
+    ],
+)
+def test_out_of_range_temporal_raises(tmp_hyper, arr, hyper_type):
+    tbl = pa.Table.from_arrays([arr], names=["col"])
+
+    msg = f"in column 'col' is out of range for Hyper type {hyper_type}"
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+
+
 def test_eight_bit_int(tmp_hyper):
     frame = pd.DataFrame(list(range(10)), columns=["nums"]).astype("int8")
 
@@ -516,3 +621,824 @@ def test_writer_can_enable_logging(tmp_hyper):
 
     assert (log_dir / "hyperd.log").exists()
     (log_dir / "hyperd.log").unlink()
+
+
+@pytest.mark.parametrize("queue_depth", [0, 1, 4])
+def test_writer_queue_depth(tmp_hyper, queue_depth):
+    batches = [
+        pa.record_batch({"int": pa.array(range(i, i + 3), type=pa.int64())})
+        for i in range(0, 30, 3)
+    ]
+    reader = pa.RecordBatchReader.from_batches(batches[0].schema, batches)
+
+    pt.frame_to_hyper(reader, tmp_hyper, table="test", queue_depth=queue_depth)
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result["int"].to_pylist() == list(range(30))
+
+
+def test_writer_negative_queue_depth_raises(tmp_hyper):
+    tbl = pa.table({"int": pa.array(range(4), type=pa.int16())})
+
+    msg = "'queue_depth' must be a non-negative integer"
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test", queue_depth=-1)
+
+
+@pytest.mark.parametrize("queue_depth", [0, 2])
+def test_writer_stream_error_raises(tmp_hyper, queue_depth):
+    schema = pa.schema([("int", pa.int64())])
+
+    def gen():
+        yield pa.record_batch({"int": pa.array([1, 2, 3])})
+        raise ValueError("stream went away")
+
+    reader = pa.RecordBatchReader.from_batches(schema, gen())
+
+    msg = "stream went away"
+    with pytest.raises(RuntimeError, match=msg):
+        pt.frame_to_hyper(reader, tmp_hyper, table="test", queue_depth=queue_depth)
+
+
+def test_writer_invalid_max_workers_raises(tmp_hyper):
+    tbl = pa.table({"int": pa.array(range(4), type=pa.int16())})
+
+    msg = "'max_workers' must be a positive integer"
+    with pytest.raises(ValueError, match=msg):
+        pt.frames_to_hyper({"test": tbl}, tmp_hyper, max_workers=0)
+
+
+def test_writer_invalid_shards_raises(tmp_hyper):
+    tbl = pa.table({"int": pa.array(range(4), type=pa.int16())})
+
+    msg = "'shards' must be a positive integer"
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test", shards=0)
+
+
+def test_writer_sharded_append_preserves_order(tmp_hyper):
+    tbl = pa.table({"int": pa.array(range(1_000), type=pa.int64())})
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+    pt.frame_to_hyper(
+        tbl.to_reader(7), tmp_hyper, table="test", table_mode="a", shards=4
+    )
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result["int"].to_pylist() == list(range(1_000)) * 2
+
+
+def test_writer_invalid_engine_raises(tmp_hyper):
+    tbl = pa.table({"int": pa.array(range(4), type=pa.int16())})
+
+    msg = "'engine' must be either 'inserter' or 'copy'"
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test", engine="bcp")
+
+
+@pytest.mark.parametrize("format", ["parquet", "csv", "arrow"])
+def test_file_to_hyper(tmp_path, tmp_hyper, format):
+    import pyarrow.csv as pa_csv
+    import pyarrow.parquet as pq
+
+    tbl = pa.table(
+        {
+            "int": pa.array([1, 2, None], type=pa.int64()),
+            "float": pa.array([1.5, None, 3.0]),
+            "text": pa.array(["foo", "bar", None]),
+        }
+    )
+
+    suffix = {"parquet": "parquet", "csv": "csv", "arrow": "arrows"}[format]
+    for idx in range(2):
+        path = tmp_path / f"part_{idx}.{suffix}"
+        if format == "parquet":
+            pq.write_table(tbl, path)
+        elif format == "csv":
+            pa_csv.write_csv(tbl, path)
+        else:
+            with pa.ipc.new_stream(path, tbl.schema) as writer:
+                writer.write_table(tbl)
+
+    pt.file_to_hyper(tmp_path / f"part_*.{suffix}", tmp_hyper, table="test")
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result["int"].to_pylist() == [1, 2, None] * 2
+    assert result["float"].to_pylist() == [1.5, None, 3.0] * 2
+    assert result["text"].to_pylist() == ["foo", "bar", None] * 2
+
+
+def test_file_to_hyper_no_matches_raises(tmp_path, tmp_hyper):
+    with pytest.raises(FileNotFoundError, match="No files found matching"):
+        pt.file_to_hyper(tmp_path / "*.parquet", tmp_hyper, table="test")
+
+
+def test_file_to_hyper_unknown_extension_raises(tmp_path, tmp_hyper):
+    path = tmp_path / "data.txt"
+    path.write_text("a,b\n1,2\n")
+
+    msg = "Could not infer file format"
+    with pytest.raises(ValueError, match=msg):
+        pt.file_to_hyper(path, tmp_hyper, table="test")
+
+
+def test_table_writer_flushes_on_threshold(tmp_hyper):
+    def batch(start):
+        return pa.table({"int": pa.array([start, start + 1], type=pa.int64())})
+
+    def read(session):
+        tbl = pt.frame_from_hyper(
+            tmp_hyper, table="test", return_type="pyarrow", session=session
+        )
+        return tbl["int"].to_pylist()
+
+    with pt.Session() as session:
+        with pt.TableWriter(
+            tmp_hyper, table="test", flush_rows=4, session=session
+        ) as writer:
+            writer.write(batch(0))
+            assert read(session) == []
+
+            writer.write(batch(2))
+            assert read(session) == [0, 1, 2, 3]
+
+            writer.write(batch(4))
+            writer.flush()
+            assert read(session) == list(range(6))
+
+            writer.write(batch(6))
+
+        assert read(session) == list(range(8))
+
+
+def test_table_writer_discards_pending_rows_on_error(tmp_hyper):
+    tbl = pa.table({"int": pa.array(range(3), type=pa.int64())})
+
+    with pytest.raises(RuntimeError, match="boom"):
+        with pt.TableWriter(tmp_hyper, table="test") as writer:
+            writer.write(tbl)
+            writer.flush()
+            writer.write(tbl)
+            raise RuntimeError("boom")
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result == tbl
+
+
+def test_table_writer_schema_mismatch_raises(tmp_hyper):
+    with pt.TableWriter(tmp_hyper, table="test") as writer:
+        writer.write(pa.table({"int": pa.array([1], type=pa.int64())}))
+
+        msg = "Column type mismatch at index 0"
+        with pytest.raises(ValueError, match=msg):
+            writer.write(pa.table({"int": pa.array(["a"])}))
+
+
+def test_table_writer_closed_raises(tmp_hyper):
+    writer = pt.TableWriter(tmp_hyper, table="test")
+    writer.close()
+
+    with pytest.raises(ValueError, match="TableWriter is closed"):
+        writer.write(pa.table({"int": pa.array([1], type=pa.int64())}))
+
+
+@pytest.mark.parametrize("shards", [1, 2])
+def test_merge_mode_replaces_matching_keys(tmp_hyper, shards):
+    existing = pa.table(
+        {
+            "id": pa.array([1, 2, 3, None], type=pa.int64()),
+            "value": pa.array(["a", "b", "c", "null"]),
+        }
+    )
+    pt.frame_to_hyper(existing, tmp_hyper, table="test")
+
+    incoming = pa.table(
+        {
+            "id": pa.array([2, 4, None], type=pa.int64()),
+            "value": pa.array(["B", "D", "NULL"]),
+        }
+    )
+    pt.frame_to_hyper(
+        incoming.to_reader(1),
+        tmp_hyper,
+        table="test",
+        table_mode="m",
+        key_columns=["id"],
+        shards=shards,
+    )
+
+    result = pt.frame_from_hyper_query(
+        tmp_hyper, "SELECT * FROM test ORDER BY id NULLS LAST", return_type="pyarrow"
+    )
+    assert result["id"].to_pylist() == [1, 2, 3, 4, None]
+    assert result["value"].to_pylist() == ["a", "B", "c", "D", "NULL"]
+
+
+def test_merge_mode_creates_missing_table(tmp_hyper):
+    tbl = pa.table({"id": pa.array([1, 2], type=pa.int64())})
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test", table_mode="m", key_columns=["id"])
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result == tbl
+
+
+def test_merge_mode_key_columns_validation(tmp_hyper):
+    tbl = pa.table({"id": pa.array([1, 2], type=pa.int64())})
+
+    msg = "'key_columns' are required when 'table_mode' is 'm'"
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test", table_mode="m")
+
+    msg = "'key_columns' can only be used when 'table_mode' is 'm'"
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test", key_columns=["id"])
+
+    msg = 'Key column "missing" not found in table'
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(
+            tbl, tmp_hyper, table="test", table_mode="m", key_columns=["missing"]
+        )
+
+
+def test_writer_converts_pandas_in_slices(tmp_hyper, monkeypatch):
+    monkeypatch.setattr("pantab._writer._CONVERSION_CHUNK_ROWS", 2)
+    df = pd.DataFrame(
+        {
+            "int": pd.Series(range(5), dtype="int64"),
+            "text": pd.Series([None, None, "a", "b", None], dtype=object),
+        }
+    )
+
+    pt.frame_to_hyper(df, tmp_hyper, table="test")
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result["int"].to_pylist() == list(range(5))
+    assert result["text"].to_pylist() == [None, None, "a", "b", None]
+
+
+def test_writer_infers_pandas_schema_from_first_slice(tmp_hyper, monkeypatch):
+    monkeypatch.setattr("pantab._writer._CONVERSION_CHUNK_ROWS", 2)
+    inferred_columns = []
+    dataframe_to_types = pyarrow.pandas_compat.dataframe_to_types
+
+    # schema inference over a frame, as done by pa.Schema.from_pandas
+    def spy(df, *args, **kwargs):
+        inferred_columns.extend(df.columns)
+        return dataframe_to_types(df, *args, **kwargs)
+
+    monkeypatch.setattr(pyarrow.pandas_compat, "dataframe_to_types", spy)
+    df = pd.DataFrame(
+        {
+            "int": pd.Series(range(5), dtype="int64"),
+            "text": pd.Series(["a", None, None, "b", "c"], dtype=object),
+            "empty": pd.Series([None, None, "x", None, None], dtype=object),
+        }
+    )
+
+    pt.frame_to_hyper(df, tmp_hyper, table="test")
+
+    # only object columns are inferred from the whole frame
+    assert inferred_columns == ["text", "empty"]
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result["int"].to_pylist() == list(range(5))
+    assert result["text"].to_pylist() == ["a", None, None, "b", "c"]
+    assert result["empty"].to_pylist() == [None, None, "x", None, None]
+
+
+def test_writer_widens_pandas_object_columns_after_first_slice(tmp_hyper, monkeypatch):
+    monkeypatch.setattr("pantab._writer._CONVERSION_CHUNK_ROWS", 2)
+    decimals = [
+        decimal.Decimal("1.5"),
+        decimal.Decimal("-2.5"),
+        decimal.Decimal("3.125"),
+        decimal.Decimal("400.5"),
+    ]
+    df = pd.DataFrame(
+        {
+            "decimal": pd.Series(decimals, dtype=object),
+            "number": pd.Series([1, 2, 3.5, 4], dtype=object),
+        }
+    )
+
+    pt.frame_to_hyper(df, tmp_hyper, table="test")
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result["decimal"].type == pa.decimal128(6, 3)
+    assert result["decimal"].to_pylist() == decimals
+    assert result["number"].to_pylist() == [1.0, 2.0, 3.5, 4.0]
+
+
+@pytest.mark.parametrize(
+    "values,expected",
+    [
+        (pa.array([10, None, 30], pa.int8()), [30, None, 10, None]),
+        (pa.array([10, None, 30], pa.int32()), [30, None, 10, None]),
+        (pa.array([10, None, 30], pa.int64()), [30, None, 10, None]),
+        (
+            pa.array([0, None, 19_000], pa.date32()),
+            [
+                datetime.date(2022, 1, 8),
+                None,
+                datetime.date(1970, 1, 1),
+                None,
+            ],
+        ),
+        (pa.array([b"a", None, b"c"], pa.binary()), [b"c", None, b"a", None]),
+    ],
+)
+def test_writer_dictionary_value_types(tmp_hyper, values, expected):
+    indices = pa.array([2, 1, 0, None], pa.int32())
+    arr = pa.DictionaryArray.from_arrays(indices, values)
+    tbl = pa.Table.from_arrays([arr], names=["col"])
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result["col"].to_pylist() == expected
+
+
+def test_writer_dictionary_across_chunks(tmp_hyper):
+    first = pa.DictionaryArray.from_arrays(pa.array([0, 1, 0]), ["x", "y"])
+    second = pa.DictionaryArray.from_arrays(pa.array([1, 0]), ["z", "w"])
+    tbl = pa.Table.from_batches(
+        [
+            pa.RecordBatch.from_arrays([first], names=["col"]),
+            pa.RecordBatch.from_arrays([second], names=["col"]),
+        ]
+    )
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result["col"].to_pylist() == ["x", "y", "x", "w", "z"]
+
+
+@pytest.mark.parametrize("max_open_partitions", [1, 64])
+def test_partitioned_write_to_files(tmp_path, max_open_partitions):
+    batches = [
+        pa.record_batch({"customer": ["a", "b", "a"], "value": [1, 2, 3]}),
+        pa.record_batch({"customer": ["c", "a", "b"], "value": [4, 5, 6]}),
+    ]
+    tbl = pa.Table.from_batches(batches)
+
+    pt.partitioned_frame_to_hyper(
+        tbl,
+        tmp_path / "{partition}.hyper",
+        table="test",
+        partition_by="customer",
+        max_open_partitions=max_open_partitions,
+    )
+
+    expected = {"a": [1, 3, 5], "b": [2, 6], "c": [4]}
+    for customer, values in expected.items():
+        result = pt.frame_from_hyper(
+            tmp_path / f"{customer}.hyper", table="test", return_type="pyarrow"
+        )
+        assert result["customer"].to_pylist() == [customer] * len(values)
+        assert result["value"].to_pylist() == values
+
+
+def test_partitioned_write_encodes_path_keys(tmp_path):
+    keys = ["../escape", "a/b", "c\\d", "..", "50%"]
+    tbl = pa.table({"key": keys, "value": list(range(len(keys)))})
+
+    out = tmp_path / "out"
+    out.mkdir()
+    pt.partitioned_frame_to_hyper(
+        tbl, out / "{partition}.hyper", table="test", partition_by="key"
+    )
+
+    # every partition stays inside the templated directory
+    assert sorted(p.name for p in tmp_path.iterdir()) == ["out"]
+    expected = {
+        "..%2Fescape.hyper": "../escape",
+        "a%2Fb.hyper": "a/b",
+        "c%5Cd.hyper": "c\\d",
+        "%2E%2E.hyper": "..",
+        "50%25.hyper": "50%",
+    }
+    assert sorted(p.name for p in out.iterdir()) == sorted(expected)
+    for filename, key in expected.items():
+        result = pt.frame_from_hyper(
+            out / filename, table="test", return_type="pyarrow"
+        )
+        assert result["key"].to_pylist() == [key]
+
+
+def test_partitioned_write_encodes_windows_reserved_keys(tmp_path):
+    expected = {
+        "a<b": "a%3Cb.hyper",
+        'say"hi': "say%22hi.hyper",
+        "p|q": "p%7Cq.hyper",
+        "why?": "why%3F.hyper",
+        "x*": "x%2A.hyper",
+        "trail.": "trail%2E.hyper",
+        "trail ": "trail%20.hyper",
+        "CON": "%43ON.hyper",
+        "com1.x": "%63om1.x.hyper",
+    }
+    tbl = pa.table({"key": list(expected), "value": list(range(len(expected)))})
+
+    pt.partitioned_frame_to_hyper(
+        tbl, tmp_path / "{partition}.hyper", table="test", partition_by="key"
+    )
+
+    assert sorted(p.name for p in tmp_path.iterdir()) == sorted(expected.values())
+    for key, filename in expected.items():
+        result = pt.frame_from_hyper(
+            tmp_path / filename, table="test", return_type="pyarrow"
+        )
+        assert result["key"].to_pylist() == [key]
+
+
+def test_partitioned_write_rejects_colliding_path_keys(tmp_path):
+    tbl = pa.table({"key": ["A", "b", "a"], "value": [1, 2, 3]})
+
+    # partitions are opened in no particular order within a chunk
+    msg = "Partition keys '(A|a)' and '(A|a)' resolve to the same file"
+    with pytest.raises(ValueError, match=msg):
+        pt.partitioned_frame_to_hyper(
+            tbl, tmp_path / "{partition}.hyper", table="test", partition_by="key"
+        )
+
+    tbl = pa.table({"key": ["a", ""], "value": [1, 2]})
+    msg = "Partition keys cannot be empty"
+    with pytest.raises(ValueError, match=msg):
+        pt.partitioned_frame_to_hyper(
+            tbl, tmp_path / "{partition}.hyper", table="test", partition_by="key"
+        )
+
+    # keys differing only in case are fine as table names
+    tbl = pa.table({"key": ["A", "a"], "value": [1, 2]})
+    db = tmp_path / "tables.hyper"
+    pt.partitioned_frame_to_hyper(tbl, db, table="t_{partition}", partition_by="key")
+    result = pt.frames_from_hyper(db, return_type="pyarrow")
+    assert sorted(result) == [("public", "t_A"), ("public", "t_a")]
+
+
+def test_partitioned_write_to_tables(tmp_hyper):
+    tbl = pa.table(
+        {
+            "region": pa.array([1, 2, 1, 3], type=pa.int32()),
+            "value": pa.array(["w", "x", "y", "z"]),
+        }
+    )
+
+    pt.partitioned_frame_to_hyper(
+        tbl,
+        tmp_hyper,
+        table=("sales", "region_{partition}"),
+        partition_by="region",
+        max_open_partitions=2,
+    )
+
+    result = pt.frames_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert sorted(result) == [
+        ("sales", "region_1"),
+        ("sales", "region_2"),
+        ("sales", "region_3"),
+    ]
+    assert result[("sales", "region_1")]["value"].to_pylist() == ["w", "y"]
+    assert result[("sales", "region_3")]["value"].to_pylist() == ["z"]
+
+
+def test_partitioned_write_validation(tmp_hyper):
+    tbl = pa.table({"key": pa.array(["a", None]), "value": pa.array([1, 2])})
+
+    msg = "Either 'database' or 'table' must contain '{partition}'"
+    with pytest.raises(ValueError, match=re.escape(msg)):
+        pt.partitioned_frame_to_hyper(tbl, tmp_hyper, table="test", partition_by="key")
+
+    msg = "'max_open_partitions' must be a positive integer"
+    with pytest.raises(ValueError, match=msg):
+        pt.partitioned_frame_to_hyper(
+            tbl,
+            tmp_hyper,
+            table="t_{partition}",
+            partition_by="key",
+            max_open_partitions=0,
+        )
+
+    msg = "Partition column 'missing' not found"
+    with pytest.raises(ValueError, match=msg):
+        pt.partitioned_frame_to_hyper(
+            tbl, tmp_hyper, table="t_{partition}", partition_by="missing"
+        )
+
+    msg = "Partition column 'key' cannot contain null values"
+    with pytest.raises(ValueError, match=msg):
+        pt.partitioned_frame_to_hyper(
+            tbl, tmp_hyper, table="t_{partition}", partition_by="key"
+        )
+
+
+def test_checkpointed_load_resumes(tmp_hyper):
+    schema = pa.schema([("int", pa.int64())])
+
+    def failing_batches():
+        yield pa.record_batch({"int": pa.array([0, 1])})
+        yield pa.record_batch({"int": pa.array([2, 3])})
+        yield pa.record_batch({"int": pa.array([4, 5])})
+        raise ValueError("stream went away")
+
+    reader = pa.RecordBatchReader.from_batches(schema, failing_batches())
+    with pytest.raises(RuntimeError, match="stream went away"):
+        pt.frame_to_hyper(
+            reader,
+            tmp_hyper,
+            table="test",
+            table_mode="a",
+            checkpoint_key="job",
+            checkpoint_rows=3,
+        )
+
+    # only the rows up to the last checkpoint were kept
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result["int"].to_pylist() == [0, 1, 2, 3]
+
+    # a restart with differently sized batches picks up after the checkpoint
+    tbl = pa.Table.from_batches(
+        [
+            pa.record_batch({"int": pa.array([0, 1, 2])}),
+            pa.record_batch({"int": pa.array([3, 4, 5])}),
+        ]
+    )
+    pt.frame_to_hyper(
+        tbl,
+        tmp_hyper,
+        table="test",
+        table_mode="a",
+        checkpoint_key="job",
+        checkpoint_rows=3,
+    )
+
+    result = pt.frames_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert list(result) == [("public", "test")]
+    assert result[("public", "test")]["int"].to_pylist() == list(range(6))
+
+
+def test_checkpoint_validation(tmp_hyper):
+    tbl = pa.table({"int": pa.array([1, 2])})
+
+    msg = "'checkpoint_rows' and 'checkpoint_bytes' require a 'checkpoint_key'"
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test", checkpoint_rows=10)
+
+    msg = "Checkpointed loads require table_mode 'a'"
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test", checkpoint_key="job")
+
+    msg = "Checkpointed loads cannot be combined"
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(
+            tbl,
+            tmp_hyper,
+            table="test",
+            table_mode="a",
+            checkpoint_key="job",
+            shards=2,
+        )
+
+
+@pytest.mark.parametrize("precision", [10, 38])
+def test_write_decimal_exceeding_precision_raises(tmp_hyper, precision):
+    # pyarrow does not validate decimals built from raw buffers, and other
+    # Arrow producers may not validate them at all
+    data = pa.py_buffer(
+        b"".join(
+            value.to_bytes(16, "little", signed=True)
+            for value in (1, -(10**precision))
+        )
+    )
+    arr = pa.Array.from_buffers(pa.decimal128(precision, 2), 2, [None, data])
+
+    msg = re.escape(
+        f"A value in column 'col' exceeds the precision of NUMERIC({precision}, 2)"
+    )
+    with pytest.raises(ValueError, match=msg):
+        pt.frame_to_hyper(pa.table({"col": arr}), tmp_hyper, table="test")
+
+    # null slots may hold anything
+    validity = pa.py_buffer(bytes([0b01]))
+    arr = pa.Array.from_buffers(
+        pa.decimal128(precision, 2), 2, [validity, data], null_count=1
+    )
+    pt.frame_to_hyper(pa.table({"col": arr}), tmp_hyper, table="test")
+
+    result = pt.frame_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert result["col"].to_pylist() == [decimal.Decimal("0.01"), None]
+
+
+def test_write_statistics(tmp_hyper):
+    tbl = pa.table(
+        {
+            "int": pa.array([3, None, 1], type=pa.int64()),
+            "text": pa.array(["b", "a", None]),
+            "binary": pa.array([b"x", b"y", b"z"]),
+        }
+    )
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test", statistics=True)
+    pt.frame_to_hyper(
+        tbl, tmp_hyper, table=("other", "test"), table_mode="a", statistics=True
+    )
+
+    stats = pt.statistics_from_hyper(tmp_hyper, table="test", return_type="pyarrow")
+    assert stats["column_name"].to_pylist() == ["int", "text", "binary"]
+    assert stats["row_count"].to_pylist() == [3, 3, 3]
+    assert stats["null_count"].to_pylist() == [1, 1, 0]
+    assert stats["distinct_count"].to_pylist() == [None] * 3
+    assert stats["min_value"].to_pylist() == ["1", "a", None]
+    assert stats["max_value"].to_pylist() == ["3", "b", None]
+
+    # appends are folded into the statistics of the whole table
+    appended = pa.table(
+        {
+            "int": pa.array([None, 7], type=pa.int64()),
+            "text": pa.array(["0", None]),
+            "binary": pa.array([b"x", None]),
+        }
+    )
+    pt.frame_to_hyper(
+        appended, tmp_hyper, table="test", table_mode="a", statistics=True
+    )
+    stats = pt.statistics_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert stats["table_name"].to_pylist() == ["test"] * 6
+    assert stats["schema_name"].to_pylist() == ["other"] * 3 + ["public"] * 3
+    assert stats["row_count"].to_pylist() == [3] * 3 + [5] * 3
+    assert stats["null_count"].to_pylist()[3:] == [2, 2, 1]
+    assert stats["min_value"].to_pylist()[3:] == ["1", "0", None]
+    assert stats["max_value"].to_pylist()[3:] == ["7", "b", None]
+
+    # the statistics table is not part of the data
+    assert set(pt.frames_from_hyper(tmp_hyper)) == {
+        ("public", "test"),
+        ("other", "test"),
+    }
+
+
+def test_write_statistics_mixed_columns(tmp_hyper):
+    tbl = pa.table(
+        {
+            "bool": pa.array([True, None, False]),
+            "it's": pa.array([2.5, -1.5, None]),
+            "binary": pa.array([b"x", None, None]),
+            "date": pa.array(
+                [datetime.date(2024, 1, 2), datetime.date(2023, 5, 6), None]
+            ),
+        }
+    )
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test", statistics=True)
+
+    stats = pt.statistics_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert stats["column_name"].to_pylist() == ["bool", "it's", "binary", "date"]
+    assert stats["column_position"].to_pylist() == [0, 1, 2, 3]
+    assert stats["row_count"].to_pylist() == [3] * 4
+    assert stats["null_count"].to_pylist() == [1, 1, 2, 1]
+    assert stats["distinct_count"].to_pylist()[0] is None
+    assert stats["distinct_count"].to_pylist()[2] is None
+    assert stats["min_value"].to_pylist() == [None, "-1.5", None, "2023-05-06"]
+    assert stats["max_value"].to_pylist() == [None, "2.5", None, "2024-01-02"]
+
+
+def test_write_statistics_ranges(tmp_hyper):
+    first = pa.table({"int": pa.array([5, None, 3], type=pa.int64())})
+    second = pa.table({"int": pa.array([10, 20], type=pa.int64())})
+
+    pt.frame_to_hyper(first, tmp_hyper, table="test", statistics=True)
+    pt.frame_to_hyper(second, tmp_hyper, table="test", table_mode="a", statistics=True)
+
+    ranges = pt.statistics_from_hyper(tmp_hyper, ranges=True, return_type="pyarrow")
+    assert ranges["first_row"].to_pylist() == [0, 3]
+    assert ranges["row_count"].to_pylist() == [3, 2]
+    assert ranges["null_count"].to_pylist() == [1, 0]
+    assert ranges["min_value"].to_pylist() == ["3", "10"]
+    assert ranges["max_value"].to_pylist() == ["5", "20"]
+
+    stats = pt.statistics_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert stats["row_count"].to_pylist() == [5]
+    assert stats["min_value"].to_pylist() == ["3"]
+    assert stats["max_value"].to_pylist() == ["20"]
+
+
+@pytest.mark.parametrize("shards", [1, 2])
+def test_write_statistics_sharded(tmp_hyper, shards):
+    tbl = pa.table({"int": pa.array(range(100), type=pa.int64())})
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test", shards=shards, statistics=True)
+
+    stats = pt.statistics_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert stats["row_count"].to_pylist() == [100]
+    assert stats["min_value"].to_pylist() == ["0"]
+    assert stats["max_value"].to_pylist() == ["99"]
+
+
+def test_write_statistics_rescan(tmp_hyper):
+    tbl = pa.table({"int": pa.array([3, None, 1, 3], type=pa.int64())})
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+    # a table without recorded statistics has nothing to add appends to
+    with pytest.raises(ValueError, match="no recorded statistics"):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test", table_mode="a", statistics=True)
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test", table_mode="a", statistics="rescan")
+    stats = pt.statistics_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert stats["row_count"].to_pylist() == [8]
+    assert stats["null_count"].to_pylist() == [2]
+    assert stats["distinct_count"].to_pylist() == [2]
+    ranges = pt.statistics_from_hyper(tmp_hyper, ranges=True, return_type="pyarrow")
+    assert ranges["first_row"].to_pylist() == [0]
+    assert ranges["row_count"].to_pylist() == [8]
+
+    # later writes can add to the rescanned statistics
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test", table_mode="a", statistics=True)
+    stats = pt.statistics_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert stats["row_count"].to_pylist() == [12]
+    assert stats["distinct_count"].to_pylist() == [None]
+
+
+def test_write_statistics_merge(tmp_hyper):
+    tbl = pa.table(
+        {
+            "key": pa.array([1, 2, 3], type=pa.int64()),
+            "val": pa.array(["a", None, "c"]),
+        }
+    )
+    update = pa.table(
+        {
+            "key": pa.array([2, 4], type=pa.int64()),
+            "val": pa.array(["b", "d"]),
+        }
+    )
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test", statistics=True)
+    pt.frame_to_hyper(
+        update,
+        tmp_hyper,
+        table="test",
+        table_mode="m",
+        key_columns=["key"],
+        statistics=True,
+    )
+
+    stats = pt.statistics_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert stats["row_count"].to_pylist() == [4, 4]
+    assert stats["null_count"].to_pylist() == [0, 0]
+    assert stats["min_value"].to_pylist() == ["1", "a"]
+    assert stats["max_value"].to_pylist() == ["4", "d"]
+    ranges = pt.statistics_from_hyper(tmp_hyper, ranges=True, return_type="pyarrow")
+    assert ranges["first_row"].to_pylist() == [0, 0]
+    assert ranges["row_count"].to_pylist() == [4, 4]
+
+
+def test_write_without_statistics_discards_them(tmp_hyper):
+    tbl = pa.table({"int": pa.array([1, 2], type=pa.int64())})
+
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test", statistics=True)
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test", table_mode="a")
+
+    stats = pt.statistics_from_hyper(tmp_hyper, return_type="pyarrow")
+    assert stats.num_rows == 0
+
+
+def test_write_statistics_sidecar(tmp_hyper, tmp_path):
+    tbl = pa.table({"int": pa.array([2, None, 1], type=pa.int64())})
+    sidecar = tmp_path / "stats.json"
+
+    with pytest.raises(ValueError, match="'statistics_sidecar' requires"):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test", statistics_sidecar=sidecar)
+
+    pt.frame_to_hyper(
+        tbl, tmp_hyper, table="test", statistics=True, statistics_sidecar=sidecar
+    )
+
+    for ranges in (False, True):
+        expected = pt.statistics_from_hyper(
+            tmp_hyper, ranges=ranges, return_type="pyarrow"
+        )
+        result = pt.statistics_from_sidecar(
+            sidecar, table="test", ranges=ranges, return_type="pyarrow"
+        )
+        assert result.equals(expected)
+
+    result = pt.statistics_from_sidecar(
+        sidecar, table=("other", "test"), return_type="pyarrow"
+    )
+    assert result.num_rows == 0
+
+
+def test_write_statistics_invalid_raises(tmp_hyper):
+    tbl = pa.table({"int": pa.array([1, 2])})
+
+    with pytest.raises(ValueError, match="'statistics' must be"):
+        pt.frame_to_hyper(tbl, tmp_hyper, table="test", statistics="always")
+
+
+def test_statistics_missing_raises(tmp_hyper):
+    tbl = pa.table({"int": pa.array([1, 2])})
+    pt.frame_to_hyper(tbl, tmp_hyper, table="test")
+
+    with pytest.raises(ValueError, match="No statistics have been recorded"):
+        pt.statistics_from_hyper(tmp_hyper)